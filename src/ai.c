@@ -1,196 +1,409 @@
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 #include "ai.h"
 #include "turn.h"
-#include "combat.h" // For engage if needed, though we might just set state
-#include "ui.h"
+#include "combat.h"
+#include "data.h"
+#include "evlog.h"
+#include "spatial.h"
+#include "region.h"
+#include "rng.h"
 
 // Helpers
 static bool ai_can_see_target(Map* map, Entity* observer, Entity* target);
-static void ai_worm_update(Entity* e, Map* map, Game* game);
+static AILod ai_lod_classify(const Entity* e, const Entity* player);
+static void ai_sleep(Entity* e, Game* game);
+static void ai_schedule(Entity* e, int ticks);
+
+// ----------------------------------------------------------------------------
+// Behaviour Tables
+// The state templates from monsters.txt are compiled once into a flat table of
+// action functions and transitions. A decision is one table step:
+//     state = table[state].next[table[state].act(e)]
+// whatever the monster family, so adding families adds rows, not branches.
+// ----------------------------------------------------------------------------
+
+#define AI_MAX_STEPS 4 // Instant actions chained in one turn
+
+typedef struct {
+    Map* map;
+    Game* game;
+    Entity* noticed; // Who set off a NOTICE transition, if any
+    int delay;       // Ticks the action took; 0 = instant, keep stepping
+} AiContext;
+
+typedef struct AiStateEntry AiStateEntry;
+typedef AiOutcome (*AiActionFn)(Entity* e, const AiStateEntry* st, AiContext* ctx);
+
+struct AiStateEntry {
+    AiActionFn act;
+    int next[AI_OUT_MAX];
+    int min, max;   // Action parameters, -1 = default
+    bool instant;   // Runs as a reflex when entered through NOTICE
+    bool start;     // Resting state of its behaviour
+};
+
+static AiStateEntry ai_table[MAX_AI_STATES];
+static int ai_table_size = 0;
+
+static AiOutcome act_wait(Entity* e, const AiStateEntry* st, AiContext* ctx);
+static AiOutcome act_wait_random(Entity* e, const AiStateEntry* st, AiContext* ctx);
+static AiOutcome act_wander(Entity* e, const AiStateEntry* st, AiContext* ctx);
+static AiOutcome act_engage(Entity* e, const AiStateEntry* st, AiContext* ctx);
+static AiOutcome act_hold(Entity* e, const AiStateEntry* st, AiContext* ctx);
+static AiOutcome act_burrow(Entity* e, const AiStateEntry* st, AiContext* ctx);
+static AiOutcome act_surface(Entity* e, const AiStateEntry* st, AiContext* ctx);
+static AiOutcome act_follow_scent(Entity* e, const AiStateEntry* st, AiContext* ctx);
+
+static const AiActionFn AI_ACTIONS[AI_ACT_MAX] = {
+    [AI_ACT_WAIT]         = act_wait,
+    [AI_ACT_WAIT_RANDOM]  = act_wait_random,
+    [AI_ACT_WANDER]       = act_wander,
+    [AI_ACT_ENGAGE]       = act_engage,
+    [AI_ACT_HOLD]         = act_hold,
+    [AI_ACT_BURROW]       = act_burrow,
+    [AI_ACT_SURFACE]      = act_surface,
+    [AI_ACT_FOLLOW_SCENT] = act_follow_scent
+};
+
+void ai_compile_behaviours(void) {
+    ai_table_size = data_ai_state_count();
+    for (int i = 0; i < ai_table_size; i++) {
+        const AiStateTemplate* t = data_get_ai_state(i);
+        AiStateEntry* st = &ai_table[i];
+        st->act = AI_ACTIONS[t->action];
+        memcpy(st->next, t->next, sizeof(st->next));
+        st->min = t->min;
+        st->max = t->max;
+        st->instant = (t->action == AI_ACT_ENGAGE);
+        st->start = t->start;
+    }
+}
+
+static bool has_behaviour(const Entity* e) {
+    return e->ai_state >= 0 && e->ai_state < ai_table_size;
+}
+
+// Steps through instant actions until one takes time
+static void ai_run(Entity* e, AiContext* ctx) {
+    for (int step = 0; step < AI_MAX_STEPS && ctx->delay == 0; step++) {
+        const AiStateEntry* st = &ai_table[e->ai_state];
+        e->ai_state = st->next[st->act(e, st, ctx)];
+    }
+}
 
 void ai_take_turn(Entity* e, Map* map, Game* game) {
     if (!e->is_active) return;
 
-    // Dispatch based on Race/Job
-    if (e->race == RACE_WORM) {
-        ai_worm_update(e, map, game);
-    } else {
-        // Fallback / Generic AI
-        // For now, just schedule next turn to prevent hanging
-        turn_add_event(turn_get_current_time() + e->move_speed, e->id, EVENT_MOVE);
+    e->ai_lod = ai_lod_classify(e, &game->player);
+    if (e->ai_lod == AI_LOD_DORMANT) {
+        ai_sleep(e, game); // No event until woken
+        return;
     }
+
+    AiContext ctx = {map, game, NULL, 0};
+    if (has_behaviour(e)) ai_run(e, &ctx);
+    ai_schedule(e, ctx.delay > 0 ? ctx.delay : e->move_speed);
 }
 
 // ----------------------------------------------------------------------------
-// Sensory Helpers
+// Level of Detail
 // ----------------------------------------------------------------------------
 
-// Bresenham's Line Algorithm for Line of Sight
-__attribute__((unused)) static bool ai_can_see_target(Map* map, Entity* observer, Entity* target) {
-    int x0 = observer->x;
-    int y0 = observer->y;
-    int x1 = target->x;
-    int y1 = target->y;
-    
+#define AI_SECTOR_SHIFT 4 // 16x16 tiles
+#define AI_SECTORS_X (MAX_MAP_WIDTH >> AI_SECTOR_SHIFT)
+#define AI_SECTORS_Y (MAX_MAP_HEIGHT >> AI_SECTOR_SHIFT)
+
+static int lod_active_radius = AI_LOD_ACTIVE_RADIUS;
+
+// Sleepers per sector: entity index + 1, chained through Entity.lod_next
+static int sector_sleepers[AI_SECTORS_X][AI_SECTORS_Y];
+static int sleeper_count = 0;
+
+void ai_lod_set_radius(int active_radius) {
+    if (active_radius < 1) active_radius = 1;
+    lod_active_radius = active_radius;
+}
+
+int ai_lod_get_radius(void) {
+    return lod_active_radius;
+}
+
+void ai_lod_reset(void) {
+    memset(sector_sleepers, 0, sizeof(sector_sleepers));
+    sleeper_count = 0;
+}
+
+void ai_lod_rebuild(Game* game) {
+    ai_lod_reset();
+    for (int i = 0; i < game->entity_count; i++) {
+        Entity* e = &game->entities[i];
+        e->lod_next = 0;
+        if (e->ai_lod == AI_LOD_DORMANT) ai_sleep(e, game);
+    }
+}
+
+int ai_lod_sleeper_count(void) {
+    return sleeper_count;
+}
+
+static int chebyshev(int x0, int y0, int x1, int y1) {
     int dx = abs(x1 - x0);
-    int dy = -abs(y1 - y0);
-    int sx = x0 < x1 ? 1 : -1;
-    int sy = y0 < y1 ? 1 : -1;
-    int err = dx + dy;
-    
-    while (true) {
-        if (x0 == x1 && y0 == y1) return true; // Reached target
-        
-        // Check obstruction (don't check start tile)
-        if (x0 != observer->x || y0 != observer->y) { // Start tile is observer
-             // For LoS, walls block.
-             if (map->tiles[x0][y0].type == TILE_WALL) return false;
+    int dy = abs(y1 - y0);
+    return dx > dy ? dx : dy;
+}
+
+static AILod ai_lod_classify(const Entity* e, const Entity* player) {
+    int d = chebyshev(e->x, e->y, player->x, player->y);
+    if (d <= lod_active_radius) return AI_LOD_ACTIVE;
+
+    // Anything mid-action keeps running, just slower
+    bool busy = e->is_engaged || e->enmity.count > 0 || e->is_burrowed ||
+                (has_behaviour(e) && !ai_table[e->ai_state].start);
+    if (busy || d <= lod_active_radius * 2) return AI_LOD_COARSE;
+    return AI_LOD_DORMANT;
+}
+
+static void ai_schedule(Entity* e, int ticks) {
+    if (e->ai_lod == AI_LOD_COARSE) ticks *= AI_LOD_COARSE_FACTOR;
+    turn_add_event(turn_get_current_time() + ticks, e->id, EVENT_MOVE);
+}
+
+static void ai_sleep(Entity* e, Game* game) {
+    int idx = (int)(e - game->entities);
+    int sx = e->x >> AI_SECTOR_SHIFT;
+    int sy = e->y >> AI_SECTOR_SHIFT;
+
+    e->lod_next = sector_sleepers[sx][sy];
+    sector_sleepers[sx][sy] = idx + 1;
+    sleeper_count++;
+}
+
+static void wake_entity(Entity* e) {
+    e->ai_lod = AI_LOD_ACTIVE; // Reclassified on its next turn
+    e->lod_next = 0;
+    sleeper_count--;
+    if (e->is_active) {
+        turn_add_event(turn_get_current_time() + e->move_speed, e->id, EVENT_MOVE);
+    }
+}
+
+// Wakes the sleepers of one sector that are within radius of (x, y)
+static void wake_sector(Game* game, int sx, int sy, int x, int y, int radius) {
+    int* link = &sector_sleepers[sx][sy];
+    while (*link) {
+        Entity* e = &game->entities[*link - 1];
+        if (chebyshev(e->x, e->y, x, y) <= radius) {
+            *link = e->lod_next;
+            wake_entity(e);
+        } else {
+            link = &e->lod_next;
+        }
+    }
+}
+
+void ai_wake_at(Game* game, int x, int y, int radius) {
+    if (sleeper_count == 0) return;
+
+    int x0 = (x - radius) >> AI_SECTOR_SHIFT, x1 = (x + radius) >> AI_SECTOR_SHIFT;
+    int y0 = (y - radius) >> AI_SECTOR_SHIFT, y1 = (y + radius) >> AI_SECTOR_SHIFT;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= AI_SECTORS_X) x1 = AI_SECTORS_X - 1;
+    if (y1 >= AI_SECTORS_Y) y1 = AI_SECTORS_Y - 1;
+
+    for (int sx = x0; sx <= x1; sx++) {
+        for (int sy = y0; sy <= y1; sy++) {
+            if (sector_sleepers[sx][sy]) wake_sector(game, sx, sy, x, y, radius);
         }
+    }
+}
+
+void ai_lod_update(Game* game) {
+    ai_wake_at(game, game->player.x, game->player.y, lod_active_radius);
+}
+
+void ai_wake(Entity* e) {
+    if (!e || e->ai_lod != AI_LOD_DORMANT) return;
+
+    // Unlink from its sector (lists are short)
+    int idx = (int)(e - g_game.entities);
+    int* link = &sector_sleepers[e->x >> AI_SECTOR_SHIFT][e->y >> AI_SECTOR_SHIFT];
+    while (*link && *link != idx + 1) link = &g_game.entities[*link - 1].lod_next;
+    if (*link) *link = e->lod_next;
+
+    wake_entity(e);
+}
+
+// ----------------------------------------------------------------------------
+// Sensory Helpers
+// ----------------------------------------------------------------------------
+
+// Reacting to stimuli
+// Anything a monster perceives wakes it. Aggressive monsters that notice a
+// player take their state's NOTICE transition; instant actions such as ENGAGE
+// run on the spot, the rest on the turn already queued.
+void ai_on_stimulus(Entity* e, const Stimulus* s, uint8_t sensed, Game* game) {
+    (void)sensed; // Already limited to the monster's DETECT senses
+    ai_wake(e);
 
-        if (2 * err >= dy) { err += dy; x0 += sx; }
-        if (2 * err <= dx) { err += dx; y0 += sy; }
+    Entity* src = game_get_entity(s->source_id);
+    if (!e->is_aggressive || !src || src->type != ENTITY_PLAYER || !src->is_active) return;
+    if (e->is_engaged || e->is_burrowed || !has_behaviour(e)) return;
+    if (!region_connected(&game->current_map, e->x, e->y, src->x, src->y)) return; // Can't get there
+
+    int next = ai_table[e->ai_state].next[AI_OUT_NOTICE];
+    if (next == e->ai_state) return; // This state ignores it
+    e->ai_state = next;
+
+    AiContext ctx = {&game->current_map, game, src, 0};
+    for (int step = 0; step < AI_MAX_STEPS && ai_table[e->ai_state].instant && ctx.delay == 0; step++) {
+        const AiStateEntry* st = &ai_table[e->ai_state];
+        e->ai_state = st->next[st->act(e, st, &ctx)];
     }
 }
 
+// Line of Sight between two entities
+__attribute__((unused)) static bool ai_can_see_target(Map* map, Entity* observer, Entity* target) {
+    return map_line_of_sight(map, observer->x, observer->y, target->x, target->y);
+}
+
 // ----------------------------------------------------------------------------
-// Specific AI Implementations
+// Actions
+// Each sets ctx->delay to the ticks it took (0 = instant) and reports how it went.
 // ----------------------------------------------------------------------------
 
-static void ai_worm_update(Entity* e, Map* map, Game* game) {
-    (void)game; // Unused for now
-    long current_time = turn_get_current_time();
-    int ticks_to_next = 100; // Default fallback cost
-
-    // State Machine
-    switch (e->ai_state) {
-        case AI_IDLE: {
-            // Wait random duration (15-45 turns)
-            int turns = 15 + (rand() % 31);
-            ticks_to_next = turns * 100;
-            
-            // Transition -> Burrowing
-            e->ai_state = AI_BURROWING;
-            // ui_log("The ground trembles..."); // Debug/Flavor?
-            break;
-        }
-        
-        case AI_BURROWING: {
-            // Dig into ground
-            e->is_burrowed = true;
-            if (map->tiles[e->x][e->y].visible) {
-                 ui_log("%s tunnels underground.", e->name);
-            }
-            map_set_occupied(map, e->x, e->y, false); // Free old tile
-            
-            // Pick destination
-            int attempts = 0;
-            int dest_x = e->x, dest_y = e->y;
-            // bool found = false;
-            
-            while (attempts < 20) {
-                int rx = (rand() % 17) - 8; // -8 to 8
-                int ry = (rand() % 17) - 8;
-                int tx = e->x + rx;
-                int ty = e->y + ry;
-                
-                if (map_is_walkable(map, tx, ty) && !map_is_occupied(map, tx, ty)) {
-                    dest_x = tx;
-                    dest_y = ty;
-                    // found = true;
-                    break;
-                }
-                attempts++;
-            }
-            
-            e->burrow_dest_x = dest_x;
-            e->burrow_dest_y = dest_y;
-            
-            // Calculate travel time
-            int dist = abs(dest_x - e->x) + abs(dest_y - e->y);
-            ticks_to_next = dist * e->move_speed;
-            
-            // Transition -> Travel
-            e->ai_state = AI_WORM_TRAVEL;
-            break;
-        }
-        
-        case AI_WORM_TRAVEL: {
-            // Resurface
-            e->x = e->burrow_dest_x;
-            e->y = e->burrow_dest_y;
-            e->is_burrowed = false;
-            
-            if (map->tiles[e->x][e->y].visible) {
-                 ui_log("%s appears from underground.", e->name);
-            }
+#define AI_BURROW_RANGE 8 // Tunnel exits lie within this many tiles
+
+static const int AI_DIRS[4][2] = {{0,-1}, {0,1}, {-1,0}, {1,0}}; // N, S, W, E
 
-            map_set_occupied(map, e->x, e->y, true); // Occupy new tile
-            
-            // Transition -> Idle
-            e->ai_state = AI_IDLE;
-            ticks_to_next = 10; // Short pause after surfacing
-            break;
+static void ai_step_to(Entity* e, Map* map, int x, int y) {
+    map_set_occupied(map, e->x, e->y, false);
+    e->x = x;
+    e->y = y;
+    map_set_occupied(map, e->x, e->y, true);
+    spatial_update(e);
+}
+
+static AiOutcome act_wait(Entity* e, const AiStateEntry* st, AiContext* ctx) {
+    ctx->delay = st->min >= 0 ? st->min : e->move_speed;
+    return AI_OUT_DONE;
+}
+
+static AiOutcome act_wait_random(Entity* e, const AiStateEntry* st, AiContext* ctx) {
+    if (st->min < 0) return act_wait(e, st, ctx);
+    ctx->delay = rng_range(st->min, st->max);
+    return AI_OUT_DONE;
+}
+
+static AiOutcome act_wander(Entity* e, const AiStateEntry* st, AiContext* ctx) {
+    (void)st;
+    ctx->delay = e->move_speed;
+    if (e->is_engaged) return AI_OUT_FAIL; // Stand and fight
+
+    int candidates[4];
+    int candidate_count = 0;
+    for (int i = 0; i < 4; i++) {
+        int nx = e->x + AI_DIRS[i][0];
+        int ny = e->y + AI_DIRS[i][1];
+        if (map_is_walkable(ctx->map, nx, ny) && !map_is_occupied(ctx->map, nx, ny)) {
+            candidates[candidate_count++] = i;
         }
+    }
+    if (candidate_count == 0) return AI_OUT_FAIL;
 
-        case AI_ENGAGED: {
-            // Aggressive tracking logic (Smell)
-            // Pick neighbor with highest smell
-            // int best_smell = -1;
-            int target_x = e->x;
-            int target_y = e->y;
-            
-            int dirs[4][2] = {{0,-1}, {0,1}, {-1,0}, {1,0}}; // N, S, W, E
-            
-            // Randomize start index to avoid bias? 
-            // Or iterate and collect candidates.
-            int candidates[4] = {-1, -1, -1, -1};
-            int candidate_count = 0;
-            int max_val = -1;
-
-            for (int i=0; i<4; i++) {
-                int nx = e->x + dirs[i][0];
-                int ny = e->y + dirs[i][1];
-                
-                if (map_is_walkable(map, nx, ny) && !map_is_occupied(map, nx, ny)) {
-                    int val = map->smell[nx][ny];
-                    if (val > max_val) {
-                        max_val = val;
-                        candidate_count = 0;
-                        candidates[candidate_count++] = i;
-                    } else if (val == max_val) {
-                        candidates[candidate_count++] = i;
-                    }
-                }
-            }
-            
-            if (max_val > 0 && candidate_count > 0) {
-                 // Pick random winner
-                 int win_idx = candidates[rand() % candidate_count];
-                 target_x = e->x + dirs[win_idx][0];
-                 target_y = e->y + dirs[win_idx][1];
-                 
-                 // Move
-                 map_set_occupied(map, e->x, e->y, false);
-                 e->x = target_x;
-                 e->y = target_y;
-                 map_set_occupied(map, e->x, e->y, true);
-                 
-                 ticks_to_next = e->move_speed;
-            } else {
-                // Lost scent or blocked
-                // Give up
-                e->ai_state = AI_IDLE;
-                ticks_to_next = 100;
+    int dir = candidates[rng_range(0, candidate_count - 1)];
+    ai_step_to(e, ctx->map, e->x + AI_DIRS[dir][0], e->y + AI_DIRS[dir][1]);
+    return AI_OUT_DONE;
+}
+
+static AiOutcome act_engage(Entity* e, const AiStateEntry* st, AiContext* ctx) {
+    (void)st;
+    Entity* target = ctx->noticed ? ctx->noticed : game_get_entity(e->target_id);
+    if (!target || !target->is_active) return AI_OUT_FAIL;
+    if (e->is_engaged) return AI_OUT_DONE;
+
+    evlog_2(EVLOG_AGGRO, evlog_entity_name(e), evlog_entity_name(target));
+    combat_engage(e, target->id);
+    return AI_OUT_DONE;
+}
+
+static AiOutcome act_hold(Entity* e, const AiStateEntry* st, AiContext* ctx) {
+    (void)st;
+    if (!e->is_engaged) return AI_OUT_FAIL;
+    ctx->delay = e->move_speed;
+    return AI_OUT_DONE;
+}
+
+// Dig in and pick where to come up; the trip takes one move per tile
+static AiOutcome act_burrow(Entity* e, const AiStateEntry* st, AiContext* ctx) {
+    (void)st;
+    Map* map = ctx->map;
+    e->is_burrowed = true;
+    if (map->tiles[e->x][e->y].visible) {
+         evlog_1(EVLOG_BURROW, evlog_entity_name(e));
+    }
+    map_set_occupied(map, e->x, e->y, false); // Free old tile
+
+    int dest_x = e->x, dest_y = e->y;
+    map_random_free_tile_near(map, e->x, e->y, AI_BURROW_RANGE, &dest_x, &dest_y); // Else stays put
+
+    e->burrow_dest_x = dest_x;
+    e->burrow_dest_y = dest_y;
+    ctx->delay = (abs(dest_x - e->x) + abs(dest_y - e->y)) * e->move_speed;
+    return AI_OUT_DONE;
+}
+
+static AiOutcome act_surface(Entity* e, const AiStateEntry* st, AiContext* ctx) {
+    Map* map = ctx->map;
+    e->x = e->burrow_dest_x;
+    e->y = e->burrow_dest_y;
+    e->is_burrowed = false;
+    spatial_update(e);
+
+    if (map->tiles[e->x][e->y].visible) {
+         evlog_1(EVLOG_SURFACE, evlog_entity_name(e));
+    }
+    map_set_occupied(map, e->x, e->y, true); // Occupy new tile
+
+    ctx->delay = st->min >= 0 ? st->min : 10; // Short pause after surfacing
+    return AI_OUT_DONE;
+}
+
+// Moves to the neighbour with the strongest smell (ties broken at random)
+static AiOutcome act_follow_scent(Entity* e, const AiStateEntry* st, AiContext* ctx) {
+    (void)st;
+    Map* map = ctx->map;
+    int candidates[4];
+    int candidate_count = 0;
+    int max_val = -1;
+
+    for (int i = 0; i < 4; i++) {
+        int nx = e->x + AI_DIRS[i][0];
+        int ny = e->y + AI_DIRS[i][1];
+
+        if (map_is_walkable(map, nx, ny) && !map_is_occupied(map, nx, ny)) {
+            int val = map->smell[nx][ny];
+            if (val > max_val) {
+                max_val = val;
+                candidate_count = 0;
+                candidates[candidate_count++] = i;
+            } else if (val == max_val) {
+                candidates[candidate_count++] = i;
             }
-            break;
         }
-        
-        default:
-            e->ai_state = AI_IDLE; 
-            break;
     }
 
-    turn_add_event(current_time + ticks_to_next, e->id, EVENT_MOVE);
+    if (max_val <= 0 || candidate_count == 0) {
+        // Lost scent or blocked: give up
+        ctx->delay = 100;
+        return AI_OUT_FAIL;
+    }
+
+    int dir = candidates[rng_range(0, candidate_count - 1)];
+    ai_step_to(e, map, e->x + AI_DIRS[dir][0], e->y + AI_DIRS[dir][1]);
+    ctx->delay = e->move_speed;
+    return AI_OUT_DONE;
 }
@@ -4,8 +4,31 @@
 #include "entity.h"
 #include "map.h"
 #include "game.h"
+#include "stimulus.h"
 
 // AI Module Entry Point
+// Monsters run the behaviour state machines declared in monsters.txt.
+void ai_compile_behaviours(void); // After data_load_monsters
 void ai_take_turn(Entity* e, Map* map, Game* game);
 
+// Level of Detail
+// Monsters within the active radius of the player act at full rate, those
+// within the dormant radius act at a coarse rate, and the rest go to sleep in
+// 16x16 sector lists with nothing queued until something wakes them.
+#define AI_LOD_ACTIVE_RADIUS 24
+#define AI_LOD_COARSE_FACTOR 4 // Coarse monsters act this many times less often
+#define AI_WAKE_RADIUS_COMBAT 8 // Sound of a fight carries this far
+
+void ai_lod_set_radius(int active_radius); // Dormant radius is twice this
+int ai_lod_get_radius(void);
+void ai_lod_reset(void);                   // Zone change: forget all sleepers
+void ai_lod_rebuild(Game* game);           // After a load: file dormant monsters again
+void ai_lod_update(Game* game);            // Wake sectors around the player
+void ai_wake_at(Game* game, int x, int y, int radius); // Stimulus reaching an area
+void ai_wake(Entity* e);                   // Wake one monster (e.g. it was attacked)
+int ai_lod_sleeper_count(void);
+
+// Perception: a stimulus reached e through the senses in `sensed` (DETECT_*)
+void ai_on_stimulus(Entity* e, const Stimulus* s, uint8_t sensed, Game* game);
+
 #endif
@@ -1,56 +1,157 @@
 #include <stdio.h>
 #include "combat.h"
 #include "turn.h"
-#include "ui.h" // For logging
+#include "evlog.h"
+#include "rng.h"
+#include "enmity.h"
+#include "game.h"
 
 void combat_engage(Entity* attacker, EntityID target_id) {
     if (attacker->is_engaged && attacker->target_id == target_id) {
-        ui_log("%s is already engaged!", attacker->name);
+        evlog_1(EVLOG_ALREADY_ENGAGED, evlog_entity_name(attacker));
         return;
     }
 
     attacker->is_engaged = true;
     attacker->target_id = target_id;
     
-    // Set default delay if 0
-    if (attacker->weapon_delay <= 0) attacker->weapon_delay = 100;
+    // Delay comes from the derived stat cache (defaults to 100)
+    entity_refresh_stats(attacker);
     
-    ui_log("%s engages target!", attacker->name);
+    evlog_1(EVLOG_ENGAGE, evlog_entity_name(attacker));
     
     // Schedule first attack immediately
     // FFXI: You engage, then delay starts filling
     // Inverse (monster->player) is true as well
-    turn_add_event(turn_get_current_time() + attacker->weapon_delay, attacker->id, EVENT_ATTACK_READY);
+    turn_cancel(attacker->attack_event); // Drop a chain left over from a previous engagement
+    attacker->attack_event = turn_add_event(turn_get_current_time() + attacker->derived.delay, attacker->id, EVENT_ATTACK_READY);
 }
 
 void combat_disengage(Entity* attacker) {
     if (!attacker->is_engaged) return;
     attacker->is_engaged = false;
-    ui_log("%s disengages.", attacker->name);
-    // Note: Pending Attack events might still pop.
-    // The handler must check `is_engaged` before executing.
+    evlog_1(EVLOG_DISENGAGE, evlog_entity_name(attacker));
+    turn_cancel(attacker->attack_event);
+    attacker->attack_event = EVENT_HANDLE_NONE;
 }
 
-void combat_execute_auto_attack(Entity* attacker, Entity* target) {
-    if (!attacker || !target) return;
+// ----------------------------------------------------------------------------
+// Auto-Attack Resolution
+// ----------------------------------------------------------------------------
+
+#define MAX_TP 3000
+#define POISON_DURATION 1500 // Ticks of Poison per landed hit (monster POISON key)
+
+static int clamp(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+AttackResult combat_execute_auto_attack(Entity* attacker, Entity* target) {
+    AttackResult res = {0};
+    res.target_id = -1;
+    if (!attacker || !target) return res;
+    res.target_id = target->id;
+    
+    // Hot path: reads cached derived stats only (flushed before resolution)
+    const Attributes* a = &attacker->current_stats;
+    const Attributes* d = &target->current_stats;
+    
+    // 1. Accuracy: 75% base, +/-1% per point of DEX vs AGI
+    int hit_rate = clamp(75 + (a->dex - d->agi), 20, 95);
+    if (rng_range(0, 99) >= hit_rate) {
+        evlog_4(EVLOG_MISS, evlog_entity_name(attacker), evlog_entity_name(target), attacker->id, target->id);
+        return res;
+    }
+    res.hit = true;
     
-    int damage = (attacker->current_stats.str > 0 ? attacker->current_stats.str : 10) + attacker->weapon_damage;
-    // Stub calculation
+    // 2. Damage: Attack vs Defense with +/-10% variance
+    int base = attacker->derived.attack / 2 + attacker->weapon_damage - target->derived.defense / 4;
+    if (base < 1) base = 1;
+    res.damage = base * rng_range(90, 110) / 100;
     
-    target->resources.hp -= damage;
+    // 3. Critical hits
+    int crit_rate = clamp(5 + (a->dex - d->agi) / 2, 1, 25);
+    if (rng_range(0, 99) < crit_rate) {
+        res.critical = true;
+        res.damage = res.damage * 3 / 2;
+    }
+    if (res.damage < 1) res.damage = 1;
+    
+    target->resources.hp -= res.damage;
     if (target->resources.hp < 0) target->resources.hp = 0;
     
-    // Gain TP
-    attacker->resources.tp += 100; // Fixed 100 TP
-    if (attacker->resources.tp > 3000) attacker->resources.tp = 3000;
+    // Hate: monsters remember who hurt them and fight back
+    if (target->type == ENTITY_ENEMY) {
+        long now = turn_get_current_time();
+        enmity_on_damage(target, attacker, res.damage, now);
+        if (target->claimed_by == -1 && attacker->type == ENTITY_PLAYER) target->claimed_by = attacker->id;
+        if (target->resources.hp > 0 && !target->is_engaged) {
+            combat_engage(target, enmity_top(target, now));
+        }
+    }
+    
+    // 4. Gain TP: slower weapons earn more per swing (100 TP at delay 100)
+    res.tp_gained = 50 + attacker->derived.delay / 2;
+    attacker->resources.tp += res.tp_gained;
+    if (attacker->resources.tp > MAX_TP) attacker->resources.tp = MAX_TP;
     
-    ui_log("%s hits %s for %d dmg. TP: %d", attacker->name, target->name, damage, attacker->resources.tp);
+    int32_t args[7] = {evlog_entity_name(attacker), evlog_entity_name(target), res.damage,
+        attacker->resources.tp, res.tp_gained, attacker->id, target->id};
+    evlog_emit(res.critical ? EVLOG_CRIT : EVLOG_HIT, 7, args);
+    
+    if (attacker->poison_power > 0 && target->resources.hp > 0) {
+        entity_add_status(target, STATUS_POISON, POISON_DURATION, attacker->poison_power);
+    }
     
     if (target->resources.hp == 0) {
-        ui_log("%s defeats %s!", attacker->name, target->name);
-        combat_disengage(attacker);
+        res.defeated = true;
+        evlog_4(EVLOG_DEFEAT, evlog_entity_name(attacker), evlog_entity_name(target), attacker->id, target->id);
+        combat_defeat(target);
         
-        target->is_active = false;
+        // Monsters move on to the next name on their list
+        if (attacker->type != ENTITY_ENEMY || enmity_top(attacker, turn_get_current_time()) < 0) {
+            combat_disengage(attacker);
+        }
         // Respawn needs to happen at map spawn points. Let's mark as inactive for now.
     }
+    return res;
+}
+
+void combat_defeat(Entity* target) {
+    // The fallen stop swinging (quietly)
+    target->is_engaged = false;
+    turn_cancel(target->attack_event);
+    target->attack_event = EVENT_HANDLE_NONE;
+    
+    target->is_active = false;
+    target->claimed_by = -1;
+    enmity_clear(target);   // Its own hate list
+    enmity_forget(target);  // Its place on everyone else's
+}
+
+AttackResult combat_handle_attack_ready(Entity* attacker, long time) {
+    AttackResult res = {0};
+    res.target_id = -1; // No swing
+    attacker->attack_event = EVENT_HANDLE_NONE; // This event just fired
+    if (!attacker->is_engaged || !attacker->is_active) return res;
+    
+    // Monsters go after whoever they hate most right now
+    if (attacker->type == ENTITY_ENEMY) {
+        EntityID top = enmity_top(attacker, time);
+        if (top >= 0) attacker->target_id = top;
+    }
+    Entity* target = game_get_entity(attacker->target_id);
+    
+    if (!target || !target->is_active) {
+        combat_disengage(attacker);
+        return res;
+    }
+    
+    res = combat_execute_auto_attack(attacker, target);
+    
+    // Schedule next attack
+    if (attacker->is_engaged) {
+        attacker->attack_event = turn_add_event(time + attacker->derived.delay, attacker->id, EVENT_ATTACK_READY);
+    }
+    return res;
 }
@@ -3,8 +3,26 @@
 
 #include "entity.h"
 
+typedef struct {
+    bool hit;
+    bool critical;
+    int damage;
+    int tp_gained;
+    bool defeated;    // Target reached 0 HP
+    EntityID target_id; // -1 if no swing happened
+} AttackResult;
+
 void combat_engage(Entity* attacker, EntityID target_id);
 void combat_disengage(Entity* attacker);
-void combat_execute_auto_attack(Entity* attacker, Entity* target);
+AttackResult combat_execute_auto_attack(Entity* attacker, Entity* target);
+
+// target reached 0 HP: stops its swings and drops it from every hate list.
+// The caller frees its tile and spatial entry (or ends the game).
+void combat_defeat(Entity* target);
+
+// EVENT_ATTACK_READY handler: swings if still engaged and queues the next swing.
+// Monsters swing at their top-enmity target.
+// Callers flush dirty stats first (see entity_flush_dirty_stats).
+AttackResult combat_handle_attack_ready(Entity* attacker, long time);
 
 #endif
@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "command.h"
+#include "combat.h"
+#include "evlog.h"
+#include "game.h"
+#include "parse.h"
+#include "phash.h"
+#include "save.h"
+#include "sim.h"
+#include "target.h"
+#include "ui.h"
+
+// Argument types in a command's spec, one character per argument. Arguments
+// after '|' are optional.
+//   e  entity token: <t>, <me> or <bt>
+//   n  number
+//   w  word
+//   r  rest of the line, ';' included (macro bodies)
+typedef struct {
+    char text[COMMAND_LINE_LEN];
+    long number;
+    EntityID entity;
+} CommandArg;
+
+typedef void (*CommandHandler)(Entity* player, const CommandArg* args, int argc);
+
+typedef struct {
+    const char* name;
+    const char* spec;
+    CommandHandler handler;
+    const char* usage;
+} CommandDef;
+
+typedef struct {
+    const char* alias;
+    const char* name;
+} CommandAlias;
+
+#define MACRO_SLOTS (COMMAND_MACRO_LAST - COMMAND_MACRO_FIRST + 1)
+static char macros[MACRO_SLOTS][COMMAND_LINE_LEN];
+
+// ----------------------------------------------------------------------------
+// Handlers
+// ----------------------------------------------------------------------------
+
+static void cmd_attack(Entity* player, const CommandArg* args, int argc) {
+    EntityID tid;
+    if (argc > 0) {
+        tid = args[0].entity;
+    } else {
+        // No target given: the Tab selection, else the nearest enemy in view
+        tid = target_selected(&g_game);
+        if (tid < 0) tid = target_nearest(&g_game, player);
+    }
+
+    if (tid == player->id) {
+        ui_log("You cannot attack yourself.");
+    } else if (tid != -1) {
+        target_select(tid);
+        combat_engage(player, tid);
+    } else {
+        evlog_emit(EVLOG_NO_TARGET, 0, NULL);
+    }
+}
+
+static void cmd_parse(Entity* player, const CommandArg* args, int argc) {
+    (void)player;
+    if (argc > 0) {
+        if (strcmp(args[0].text, "reset") != 0) {
+            ui_log("Usage: /parse [reset]");
+            return;
+        }
+        parse_reset();
+        ui_log("Parse reset.");
+    } else {
+        parse_update();
+        parse_report();
+    }
+}
+
+static void cmd_map(Entity* player, const CommandArg* args, int argc) {
+    (void)player;
+    (void)args;
+    (void)argc;
+    sim_request_overview(); // Drawn by the main thread from the next snapshot
+}
+
+static void cmd_lag(Entity* player, const CommandArg* args, int argc) {
+    (void)player;
+    if (!sim_realtime()) {
+        ui_log("The clock is turn-based (see --realtime).");
+        return;
+    }
+    if (argc > 0) {
+        if (strcmp(args[0].text, "reset") != 0) {
+            ui_log("Usage: /lag [reset]");
+            return;
+        }
+        sim_clock_reset_stats();
+        ui_log("Lag stats reset.");
+        return;
+    }
+
+    const SimClockStats* st = sim_clock_stats();
+    int64_t wall = st->busy_ns + st->idle_ns;
+    ui_log("Clock: %d ticks/s, %ld events, %ld late, busy %.0f%%", sim_realtime(), st->events, st->late,
+        wall > 0 ? 100.0 * st->busy_ns / wall : 0.0);
+    ui_log("  lag p50 %.1fms p99 %.1fms max %.1fms", parse_hist_percentile(&st->lag_us, 0.50) / 1000.0,
+        parse_hist_percentile(&st->lag_us, 0.99) / 1000.0, st->lag_us.max / 1000.0);
+    ui_log("  drift %.0fms (%ld resyncs)", st->drift_ns / 1e6, st->resyncs);
+}
+
+static void cmd_save(Entity* player, const CommandArg* args, int argc) {
+    (void)player;
+    game_save(argc > 0 ? args[0].text : SAVE_DEFAULT_PATH);
+}
+
+static void cmd_load(Entity* player, const CommandArg* args, int argc) {
+    (void)player;
+    game_load(argc > 0 ? args[0].text : SAVE_DEFAULT_PATH);
+}
+
+static void cmd_check(Entity* player, const CommandArg* args, int argc) {
+    // No target given: the Tab selection, else yourself
+    EntityID tid = argc > 0 ? args[0].entity : target_selected(&g_game);
+    Entity* e = tid < 0 ? player : game_get_entity(tid);
+    if (!e || (e != player && !e->is_active)) {
+        ui_log("That target is gone.");
+        return;
+    }
+    ui_log("%s: Lv.%d  HP %d/%d", e->name, e->current_level, e->resources.hp, e->resources.max_hp);
+}
+
+static void cmd_macro(Entity* player, const CommandArg* args, int argc) {
+    (void)player;
+    if (argc == 0) {
+        bool any = false;
+        for (int i = 0; i < MACRO_SLOTS; i++) {
+            if (!macros[i][0]) continue;
+            ui_log("F%d: %s", COMMAND_MACRO_FIRST + i, macros[i]);
+            any = true;
+        }
+        if (!any) ui_log("No macros. Usage: /macro <5-12> <commands>");
+        return;
+    }
+
+    long slot = args[0].number;
+    if (slot < COMMAND_MACRO_FIRST || slot > COMMAND_MACRO_LAST) {
+        ui_log("Macro slots are %d-%d (F%d-F%d).", COMMAND_MACRO_FIRST, COMMAND_MACRO_LAST,
+            COMMAND_MACRO_FIRST, COMMAND_MACRO_LAST);
+        return;
+    }
+    char* body = macros[slot - COMMAND_MACRO_FIRST];
+
+    if (argc == 1) {
+        body[0] = 0;
+        ui_log("Macro F%ld cleared.", slot);
+    } else if (args[1].text[0] != '/') {
+        ui_log("Macros hold slash commands, e.g. /macro %ld /attack <bt>", slot);
+    } else {
+        snprintf(body, COMMAND_LINE_LEN, "%s", args[1].text);
+        ui_log("Macro F%ld: %s", slot, body);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Registry
+// ----------------------------------------------------------------------------
+
+static const CommandDef COMMANDS[] = {
+    {"/attack", "|e",  cmd_attack, "/attack [<t>|<bt>]"},
+    {"/parse",  "|w",  cmd_parse,  "/parse [reset]"},
+    {"/map",    "",    cmd_map,    "/map"},
+    {"/lag",    "|w",  cmd_lag,    "/lag [reset]"},
+    {"/save",   "|w",  cmd_save,   "/save [file]"},
+    {"/load",   "|w",  cmd_load,   "/load [file]"},
+    {"/check",  "|e",  cmd_check,  "/check [<t>|<bt>|<me>]"},
+    {"/macro",  "|nr", cmd_macro,  "/macro [<5-12> [<commands>]]"},
+};
+#define COMMAND_COUNT ((int)(sizeof(COMMANDS) / sizeof(COMMANDS[0])))
+
+static const CommandAlias ALIASES[] = {
+    {"/a",   "/attack"},
+    {"/c",   "/check"},
+    {"/mac", "/macro"},
+};
+#define ALIAS_COUNT ((int)(sizeof(ALIASES) / sizeof(ALIASES[0])))
+
+// Names and aliases share one table; key_command maps a key to COMMANDS
+static const char* keys[COMMAND_COUNT + ALIAS_COUNT];
+static int key_command[COMMAND_COUNT + ALIAS_COUNT];
+static PerfectHash command_hash;
+
+static int find_command(const char* name) {
+    for (int i = 0; i < COMMAND_COUNT; i++) {
+        if (strcmp(COMMANDS[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+void command_init(void) {
+    int count = 0;
+    for (int i = 0; i < COMMAND_COUNT; i++) {
+        keys[count] = COMMANDS[i].name;
+        key_command[count++] = i;
+    }
+    for (int i = 0; i < ALIAS_COUNT; i++) {
+        int c = find_command(ALIASES[i].name);
+        if (c < 0) {
+            fprintf(stderr, "FATAL: Alias %s names unknown command %s\n", ALIASES[i].alias, ALIASES[i].name);
+            exit(1);
+        }
+        keys[count] = ALIASES[i].alias;
+        key_command[count++] = c;
+    }
+
+    // Any set of distinct names up to PHASH_MAX_SLOTS / 2 builds (make check)
+    if (!phash_build(&command_hash, keys, count)) {
+        fprintf(stderr, "FATAL: Could not build the command table (%d names, duplicates or over %d)\n",
+            count, PHASH_MAX_SLOTS / 2);
+        exit(1);
+    }
+    memset(macros, 0, sizeof(macros));
+}
+
+// ----------------------------------------------------------------------------
+// Tokenizer
+// ----------------------------------------------------------------------------
+
+static const char* skip_spaces(const char* p) {
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+static bool at_separator(const char* p) {
+    return *p == 0 || *p == ';';
+}
+
+// Copies the token at p into out (at most len - 1 chars). Returns the end of
+// the token; *too_long is set if it did not fit.
+static const char* read_token(const char* p, char* out, int len, bool* too_long) {
+    int n = 0;
+    *too_long = false;
+    while (*p && *p != ';' && *p != ' ' && *p != '\t') {
+        if (n < len - 1) out[n++] = *p;
+        else *too_long = true;
+        p++;
+    }
+    out[n] = 0;
+    return p;
+}
+
+static const char* skip_command(const char* p) {
+    while (!at_separator(p)) p++;
+    return *p == ';' ? p + 1 : p;
+}
+
+static bool resolve_entity(const char* token, const Entity* player, EntityID* out) {
+    if (strcmp(token, "<me>") == 0) {
+        *out = player->id;
+        return true;
+    }
+    if (strcmp(token, "<t>") == 0) {
+        *out = target_selected(&g_game);
+        if (*out < 0 && player->is_engaged) *out = player->target_id;
+        if (*out < 0) {
+            ui_log("You have no target (Tab selects one).");
+            return false;
+        }
+        return true;
+    }
+    if (strcmp(token, "<bt>") == 0) {
+        *out = target_battle(&g_game, player);
+        if (*out < 0) {
+            ui_log("Nothing is fighting you.");
+            return false;
+        }
+        return true;
+    }
+    ui_log("Expected <t>, <me> or <bt>, not %s", token);
+    return false;
+}
+
+static bool parse_number(const char* token, long* out) {
+    char* end;
+    *out = strtol(token, &end, 10);
+    return end != token && *end == 0;
+}
+
+// Runs the command at p; returns where the next one starts
+static const char* run_one(const char* p, Entity* player) {
+    bool too_long;
+    char name[COMMAND_TOKEN_LEN];
+    p = read_token(skip_spaces(p), name, sizeof(name), &too_long);
+    if (!name[0]) return skip_command(p); // Empty: "; ;"
+
+    int key = too_long ? -1 : phash_lookup(&command_hash, keys, name);
+    if (key < 0) {
+        ui_log("Unknown command: %s", name);
+        return skip_command(p);
+    }
+    const CommandDef* def = &COMMANDS[key_command[key]];
+
+    CommandArg args[COMMAND_MAX_ARGS];
+    int argc = 0;
+    bool optional = false;
+    for (const char* s = def->spec; *s; s++) {
+        if (*s == '|') {
+            optional = true;
+            continue;
+        }
+        p = skip_spaces(p);
+        if (at_separator(p)) {
+            if (optional) break;
+            ui_log("Usage: %s", def->usage);
+            return skip_command(p);
+        }
+
+        CommandArg* a = &args[argc++];
+        if (*s == 'r') {
+            int n = 0;
+            while (*p && n < COMMAND_LINE_LEN - 1) a->text[n++] = *p++;
+            a->text[n] = 0;
+            while (n > 0 && (a->text[n - 1] == ' ' || a->text[n - 1] == '\t')) a->text[--n] = 0;
+            continue;
+        }
+
+        p = read_token(p, a->text, COMMAND_TOKEN_LEN, &too_long);
+        if (too_long) {
+            ui_log("Argument too long: %.16s...", a->text);
+            return skip_command(p);
+        }
+        if (*s == 'e' && !resolve_entity(a->text, player, &a->entity)) return skip_command(p);
+        if (*s == 'n' && !parse_number(a->text, &a->number)) {
+            ui_log("Usage: %s", def->usage);
+            return skip_command(p);
+        }
+    }
+
+    p = skip_spaces(p);
+    if (!at_separator(p)) {
+        ui_log("Usage: %s", def->usage);
+        return skip_command(p);
+    }
+    def->handler(player, args, argc);
+    return skip_command(p);
+}
+
+// ----------------------------------------------------------------------------
+// Execution
+// ----------------------------------------------------------------------------
+
+void command_execute(const char* line, Entity* player) {
+    const char* p = line;
+    while (*p) p = run_one(p, player);
+}
+
+bool command_run_macro(int slot, Entity* player) {
+    if (slot < COMMAND_MACRO_FIRST || slot > COMMAND_MACRO_LAST) return false;
+
+    // Copy: the macro may rebind its own slot
+    char line[COMMAND_LINE_LEN];
+    memcpy(line, macros[slot - COMMAND_MACRO_FIRST], COMMAND_LINE_LEN);
+    if (!line[0]) return false;
+    command_execute(line, player);
+    return true;
+}
@@ -0,0 +1,31 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include "entity.h"
+
+// Slash Commands
+// Command lines are split by a bounded tokenizer, and each name (aliases
+// included) is found through a perfect hash: one hash, one table read and one
+// strcmp, however many commands there are. Arguments are typed per command:
+// entity tokens (<t>, <me>, <bt>), numbers and words are checked before the
+// handler runs. Several commands can share a line, separated by ';'.
+//
+// Macros: /macro <5-12> <commands> binds a command line to F5-F12, like an
+// FFXI macro bar. /macro lists the bar, /macro <n> clears a slot.
+
+#define COMMAND_LINE_LEN 128  // Longest command line, macros included
+#define COMMAND_MAX_ARGS 4
+#define COMMAND_TOKEN_LEN 32   // Longest single argument
+
+#define COMMAND_MACRO_FIRST 5 // F5
+#define COMMAND_MACRO_LAST 12 // F12
+
+void command_init(void); // Builds the name table; fatal if it cannot
+
+// Runs one or more ';'-separated commands typed by (or bound for) player
+void command_execute(const char* line, Entity* player);
+
+// Runs the macro on key F<slot>; false if the slot is empty
+bool command_run_macro(int slot, Entity* player);
+
+#endif
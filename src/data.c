@@ -1,32 +1,583 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
 #include "data.h"
+#include "phash.h"
 #include "ui.h"
 
+// ----------------------------------------------------------------------------
+// String Interning
+// ----------------------------------------------------------------------------
+
+#define STRING_POOL_SIZE 8192
+
+static char string_pool[STRING_POOL_SIZE];
+static int string_pool_used = 0;
+
+// Returns a stable copy of s. Identical strings share storage.
+static const char* data_intern(const char* s) {
+    for (int off = 0; off < string_pool_used; off += strlen(string_pool + off) + 1) {
+        if (strcmp(string_pool + off, s) == 0) return string_pool + off;
+    }
+
+    int len = strlen(s) + 1;
+    if (string_pool_used + len > STRING_POOL_SIZE) {
+        fprintf(stderr, "FATAL: Template string pool exhausted\n");
+        exit(1);
+    }
+    char* out = string_pool + string_pool_used;
+    memcpy(out, s, len);
+    string_pool_used += len;
+    return out;
+}
+
+// ----------------------------------------------------------------------------
+// Template Tables
+// ----------------------------------------------------------------------------
+
+static JobTemplate job_templates[JOB_MAX];
+
+static MonsterTemplate monster_templates[MAX_MONSTER_TEMPLATES];
+static const char* monster_names[MAX_MONSTER_TEMPLATES];
+static int monster_count = 0;
+static PerfectHash monster_hash;
+
+static AiStateTemplate ai_states[MAX_AI_STATES];
+static const char* ai_next_names[MAX_AI_STATES][AI_OUT_MAX]; // Resolved after loading
+static int ai_state_count = 0;
+
+// Keys used in the data files, indexed by enum
+static const char* JOB_KEYS[JOB_MAX] = {
+    [JOB_WARRIOR]    = "WARRIOR",
+    [JOB_MONK]       = "MONK",
+    [JOB_THIEF]      = "THIEF",
+    [JOB_BLACK_MAGE] = "BLACK_MAGE",
+    [JOB_WHITE_MAGE] = "WHITE_MAGE",
+    [JOB_RED_MAGE]   = "RED_MAGE",
+    [JOB_WORM]       = "WORM"
+};
+
+static const char* RACE_KEYS[RACE_MAX] = {
+    [RACE_HUME]     = "HUME",
+    [RACE_ELVAAN]   = "ELVAAN",
+    [RACE_TARUTARU] = "TARUTARU",
+    [RACE_MITHRA]   = "MITHRA",
+    [RACE_GALKA]    = "GALKA",
+    [RACE_WORM]     = "WORM"
+};
+
+static const char* AI_ACTION_KEYS[AI_ACT_MAX] = {
+    [AI_ACT_WAIT]         = "WAIT",
+    [AI_ACT_WAIT_RANDOM]  = "WAIT_RANDOM",
+    [AI_ACT_WANDER]       = "WANDER",
+    [AI_ACT_ENGAGE]       = "ENGAGE",
+    [AI_ACT_HOLD]         = "HOLD",
+    [AI_ACT_BURROW]       = "BURROW",
+    [AI_ACT_SURFACE]      = "SURFACE",
+    [AI_ACT_FOLLOW_SCENT] = "FOLLOW_SCENT"
+};
+
+static const char* AI_OUTCOME_KEYS[AI_OUT_MAX] = {
+    [AI_OUT_DONE]   = "DONE",
+    [AI_OUT_FAIL]   = "FAIL",
+    [AI_OUT_NOTICE] = "NOTICE"
+};
+
+// ----------------------------------------------------------------------------
+// Parsing Helpers
+// ----------------------------------------------------------------------------
+
+static const char* parse_file = "";
+static int parse_line = 0;
+static int parse_errors = 0;
+
+static void data_error(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s:%d: ", parse_file, parse_line);
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    parse_errors++;
+}
+
+static void data_begin(const char* filename) {
+    parse_file = filename;
+    parse_line = 0;
+    parse_errors = 0;
+}
+
+static void data_end(void) {
+    if (parse_errors > 0) {
+        fprintf(stderr, "FATAL: %d error(s) in %s\n", parse_errors, parse_file);
+        exit(1);
+    }
+}
+
+static bool parse_int(const char* key, const char* val, int* out) {
+    char* end;
+    long v = strtol(val, &end, 10);
+    if (*val == '\0' || *end != '\0') {
+        data_error("%s expects a number, got '%s'", key, val);
+        return false;
+    }
+    *out = (int)v;
+    return true;
+}
+
+static int find_key(const char* const* keys, int count, const char* val) {
+    for (int i = 0; i < count; i++) {
+        if (keys[i] && strcmp(keys[i], val) == 0) return i;
+    }
+    return -1;
+}
+
+// Returns the field for STR/DEX/VIT/AGI/INT/MND/CHR keys, or NULL for other keys
+static int* attribute_field(Attributes* a, const char* key) {
+    if (strcmp(key, "STR") == 0) return &a->str;
+    if (strcmp(key, "DEX") == 0) return &a->dex;
+    if (strcmp(key, "VIT") == 0) return &a->vit;
+    if (strcmp(key, "AGI") == 0) return &a->agi;
+    if (strcmp(key, "INT") == 0) return &a->intel;
+    if (strcmp(key, "MND") == 0) return &a->mnd;
+    if (strcmp(key, "CHR") == 0) return &a->chr;
+    return NULL;
+}
+
+// Splits "Name:K=V,K=V" in place. Returns the number of pairs, or -1 on error.
+#define MAX_FIELDS 24
+typedef struct {
+    char* key;
+    char* val;
+} Field;
+
+static int split_record(char* line, char** name, Field fields[MAX_FIELDS]) {
+    char* colon = strchr(line, ':');
+    if (!colon) {
+        data_error("expected 'Name:KEY=VALUE,...'");
+        return -1;
+    }
+    *colon = '\0';
+    *name = line;
+    if (**name == '\0') {
+        data_error("missing name before ':'");
+        return -1;
+    }
+
+    int count = 0;
+    char* cursor = colon + 1;
+    while (*cursor) {
+        char* next = strchr(cursor, ',');
+        if (next) *next = '\0';
+
+        if (*cursor != '\0') {
+            char* eq = strchr(cursor, '=');
+            if (!eq) {
+                data_error("field '%s' is missing '='", cursor);
+                return -1;
+            }
+            if (count >= MAX_FIELDS) {
+                data_error("too many fields (max %d)", MAX_FIELDS);
+                return -1;
+            }
+            *eq = '\0';
+            fields[count].key = cursor;
+            fields[count].val = eq + 1;
+            count++;
+        }
+
+        if (!next) break;
+        cursor = next + 1;
+    }
+    return count;
+}
+
+// Reads the next record line. Skips blanks and '%' comments like the map format.
+static bool next_record(FILE* f, char* line, int size) {
+    while (fgets(line, size, f)) {
+        parse_line++;
+        line[strcspn(line, "\r\n")] = 0;
+        if (strlen(line) == 0) continue;
+        if (line[0] == '%') continue; // Comment
+        return true;
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// Loaders
+// ----------------------------------------------------------------------------
+
 void data_init_loaders(void) {
-    // Stub
+    memset(job_templates, 0, sizeof(job_templates));
+    memset(monster_templates, 0, sizeof(monster_templates));
+    memset(&monster_hash, 0, sizeof(monster_hash));
+    memset(ai_states, 0, sizeof(ai_states));
+    memset(ai_next_names, 0, sizeof(ai_next_names));
+    monster_count = 0;
+    ai_state_count = 0;
+    string_pool_used = 0;
 }
 
 void data_load_jobs(const char* filename) {
-    // Stub implementation
     FILE* f = fopen(filename, "r");
     if (!f) {
-        ui_log("Error: Could not open %s", filename);
-        return;
+        fprintf(stderr, "FATAL: Could not open %s\n", filename);
+        exit(1);
+    }
+
+    data_begin(filename);
+    bool defined[JOB_MAX] = {false};
+    char line[256];
+
+    while (next_record(f, line, sizeof(line))) {
+        char* name;
+        Field fields[MAX_FIELDS];
+        int count = split_record(line, &name, fields);
+        if (count < 0) continue;
+
+        int j = find_key(JOB_KEYS, JOB_MAX, name);
+        if (j < 0) {
+            data_error("unknown job '%s'", name);
+            continue;
+        }
+        if (defined[j]) {
+            data_error("job '%s' defined twice", name);
+            continue;
+        }
+        defined[j] = true;
+
+        JobTemplate* t = &job_templates[j];
+        memset(t, 0, sizeof(JobTemplate));
+        t->name = data_intern(name);
+        t->abbr = t->name;
+
+        for (int i = 0; i < count; i++) {
+            const char* key = fields[i].key;
+            const char* val = fields[i].val;
+            int* attr = attribute_field(&t->mods, key);
+
+            if (attr) parse_int(key, val, attr);
+            else if (strcmp(key, "NAME") == 0) t->name = data_intern(val);
+            else if (strcmp(key, "ABBR") == 0) t->abbr = data_intern(val);
+            else if (strcmp(key, "HPL") == 0) parse_int(key, val, &t->hp_per_level);
+            else if (strcmp(key, "MPL") == 0) parse_int(key, val, &t->mp_per_level);
+            else data_error("unknown job key '%s'", key);
+        }
     }
-    // Parse logic here
     fclose(f);
+
+    for (int j = 0; j < JOB_MAX; j++) {
+        if (!defined[j]) {
+            parse_line = 0;
+            data_error("job '%s' is not defined", JOB_KEYS[j]);
+        }
+    }
+    data_end();
     ui_log("Loaded Jobs from %s", filename);
 }
 
+// Parses "SIGHT|SMELL" into DETECT_* flags
+static bool parse_detect(const char* val, uint8_t* out) {
+    char buf[64];
+    strncpy(buf, val, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    uint8_t flags = 0;
+    for (char* tok = strtok(buf, "|"); tok; tok = strtok(NULL, "|")) {
+        if (strcmp(tok, "SIGHT") == 0) flags |= DETECT_SIGHT;
+        else if (strcmp(tok, "SOUND") == 0) flags |= DETECT_SOUND;
+        else if (strcmp(tok, "SMELL") == 0) flags |= DETECT_SMELL;
+        else if (strcmp(tok, "MAGIC") == 0) flags |= DETECT_MAGIC;
+        else if (strcmp(tok, "NONE") != 0) {
+            data_error("unknown DETECT flag '%s'", tok);
+            return false;
+        }
+    }
+    *out = flags;
+    return true;
+}
+
+// "@Behaviour:STATE=ACTION,DONE=STATE,..." adds one state. The first state of
+// a behaviour is where its monsters start.
+static void compile_ai_state(const char* behaviour, Field* fields, int count) {
+    if (count < 1) {
+        data_error("behaviour '%s' needs STATE=ACTION", behaviour);
+        return;
+    }
+    if (ai_state_count >= MAX_AI_STATES) {
+        data_error("too many behaviour states (max %d)", MAX_AI_STATES);
+        return;
+    }
+
+    int idx = ai_state_count;
+    AiStateTemplate* st = &ai_states[idx];
+    memset(st, 0, sizeof(AiStateTemplate));
+    st->behaviour = data_intern(behaviour);
+    st->name = data_intern(fields[0].key);
+    st->start = true;
+    for (int i = 0; i < idx; i++) {
+        if (ai_states[i].behaviour != st->behaviour) continue;
+        st->start = false;
+        if (ai_states[i].name == st->name) {
+            data_error("state '%s' defined twice in '%s'", st->name, behaviour);
+            return;
+        }
+    }
+
+    int a = find_key(AI_ACTION_KEYS, AI_ACT_MAX, fields[0].val);
+    if (a < 0) {
+        data_error("unknown action '%s'", fields[0].val);
+        return;
+    }
+    st->action = (AiAction)a;
+    st->min = st->max = -1; // Action default
+    for (int o = 0; o < AI_OUT_MAX; o++) {
+        st->next[o] = idx;
+        ai_next_names[idx][o] = NULL;
+    }
+
+    for (int i = 1; i < count; i++) {
+        const char* key = fields[i].key;
+        const char* val = fields[i].val;
+        int o = find_key(AI_OUTCOME_KEYS, AI_OUT_MAX, key);
+
+        if (o >= 0) ai_next_names[idx][o] = data_intern(val);
+        else if (strcmp(key, "TICKS") == 0) {
+            if (parse_int(key, val, &st->min)) st->max = st->min;
+        }
+        else if (strcmp(key, "MIN") == 0) parse_int(key, val, &st->min);
+        else if (strcmp(key, "MAX") == 0) parse_int(key, val, &st->max);
+        else data_error("unknown behaviour key '%s'", key);
+    }
+    if (st->min > st->max) {
+        data_error("MIN is larger than MAX");
+        return;
+    }
+    ai_state_count++;
+}
+
+// Transitions may name states declared further down
+static void resolve_ai_transitions(void) {
+    for (int i = 0; i < ai_state_count; i++) {
+        AiStateTemplate* st = &ai_states[i];
+        for (int o = 0; o < AI_OUT_MAX; o++) {
+            const char* target = ai_next_names[i][o];
+            if (!target) continue;
+
+            int found = -1;
+            for (int j = 0; j < ai_state_count && found < 0; j++) {
+                if (ai_states[j].behaviour == st->behaviour && ai_states[j].name == target) found = j;
+            }
+            if (found < 0) {
+                parse_line = 0;
+                data_error("%s.%s: %s goes to unknown state '%s'", st->behaviour, st->name,
+                    AI_OUTCOME_KEYS[o], target);
+            } else {
+                st->next[o] = found;
+            }
+        }
+    }
+}
+
+static int find_behaviour(const char* name) {
+    for (int i = 0; i < ai_state_count; i++) {
+        if (ai_states[i].start && strcmp(ai_states[i].behaviour, name) == 0) return i;
+    }
+    return -1;
+}
+
+static void compile_monster(MonsterTemplate* t, const char* name, Field* fields, int count) {
+    Entity* e = &t->proto;
+    memset(e, 0, sizeof(Entity));
+
+    // Defaults
+    RaceType race = RACE_HUME;
+    JobType job = JOB_WARRIOR;
+    int level = 1;
+    int hp = -1;
+    Attributes stats = {0};
+    Attributes given = {0}; // 1 where the line sets the attribute
+
+    e->type = ENTITY_ENEMY;
+    e->is_active = true;
+    e->symbol = name[0];
+    e->color_pair = 3; // Red
+    e->move_speed = 100;
+    e->claimed_by = -1;
+    e->target_id = -1;
+    e->ai_state = -1;
+
+    for (int i = 0; i < count; i++) {
+        const char* key = fields[i].key;
+        const char* val = fields[i].val;
+        int* attr = attribute_field(&stats, key);
+        int v;
+
+        if (attr) {
+            if (parse_int(key, val, attr)) *attribute_field(&given, key) = 1;
+        } else if (strcmp(key, "HP") == 0) {
+            if (parse_int(key, val, &v)) {
+                if (v <= 0) data_error("HP must be positive");
+                else hp = v;
+            }
+        } else if (strcmp(key, "LVL") == 0) {
+            if (parse_int(key, val, &v)) {
+                if (v < 1 || v > 99) data_error("LVL must be 1-99");
+                else level = v;
+            }
+        } else if (strcmp(key, "RACE") == 0) {
+            int r = find_key(RACE_KEYS, RACE_MAX, val);
+            if (r < 0) data_error("unknown race '%s'", val);
+            else race = (RaceType)r;
+        } else if (strcmp(key, "JOB") == 0) {
+            int j = find_key(JOB_KEYS, JOB_MAX, val);
+            if (j < 0) data_error("unknown job '%s'", val);
+            else job = (JobType)j;
+        } else if (strcmp(key, "SYM") == 0) {
+            if (strlen(val) != 1) data_error("SYM must be a single character");
+            else e->symbol = val[0];
+        } else if (strcmp(key, "COLOR") == 0) {
+            parse_int(key, val, &e->color_pair);
+        } else if (strcmp(key, "SPEED") == 0) {
+            if (parse_int(key, val, &v)) {
+                if (v <= 0) data_error("SPEED must be positive");
+                else e->move_speed = v;
+            }
+        } else if (strcmp(key, "DELAY") == 0) {
+            parse_int(key, val, &e->weapon_delay);
+        } else if (strcmp(key, "DMG") == 0) {
+            parse_int(key, val, &e->weapon_damage);
+        } else if (strcmp(key, "POISON") == 0) {
+            if (parse_int(key, val, &v)) {
+                if (v < 0) data_error("POISON must not be negative");
+                else e->poison_power = v;
+            }
+        } else if (strcmp(key, "AGGRO") == 0) {
+            if (parse_int(key, val, &v)) e->is_aggressive = (v != 0);
+        } else if (strcmp(key, "DETECT") == 0) {
+            parse_detect(val, &e->detection_flags);
+        } else if (strcmp(key, "AI") == 0) {
+            e->ai_state = find_behaviour(val);
+            if (e->ai_state < 0) data_error("unknown behaviour '%s' (declare it above)", val);
+        } else {
+            data_error("unknown monster key '%s'", key);
+        }
+    }
+
+    strncpy(e->name, name, MAX_NAME_LEN - 1);
+
+    // Derive once here so every spawn is a plain copy
+    entity_init_stats(e, race, job);
+    for (int i = 0; i < count; i++) {
+        // Only the attributes the line names replace the RACE/JOB base
+        int* base = attribute_field(&e->base_stats, fields[i].key);
+        if (base && *attribute_field(&given, fields[i].key)) *base = *attribute_field(&stats, fields[i].key);
+    }
+    if (hp > 0) e->base_hp = hp;
+    e->current_level = level;
+    e->job_levels[job] = level;
+    entity_mark_dirty(e);
+    entity_refresh_stats(e);
+
+    // HP in the file is the final pool at LVL
+    if (hp > 0 && e->derived.max_hp != hp) {
+        e->base_hp += hp - e->derived.max_hp;
+        entity_mark_dirty(e);
+        entity_refresh_stats(e);
+    }
+    e->resources.hp = e->resources.max_hp;
+    e->resources.mp = e->resources.max_mp;
+    e->resources.max_tp = 3000;
+}
+
 void data_load_monsters(const char* filename) {
-    // Stub implementation
     FILE* f = fopen(filename, "r");
     if (!f) {
-        ui_log("Error: Could not open %s", filename);
-        return;
+        fprintf(stderr, "FATAL: Could not open %s\n", filename);
+        exit(1);
+    }
+
+    data_begin(filename);
+    char line[256];
+
+    while (next_record(f, line, sizeof(line))) {
+        bool is_behaviour = (line[0] == '@');
+        char* name;
+        Field fields[MAX_FIELDS];
+        int count = split_record(is_behaviour ? line + 1 : line, &name, fields);
+        if (count < 0) continue;
+
+        if (is_behaviour) {
+            compile_ai_state(name, fields, count);
+            continue;
+        }
+
+        if (strlen(name) >= MAX_NAME_LEN) {
+            data_error("monster name '%s' is longer than %d characters", name, MAX_NAME_LEN - 1);
+            continue;
+        }
+        if (find_key(monster_names, monster_count, name) >= 0) {
+            data_error("monster '%s' defined twice", name);
+            continue;
+        }
+        if (monster_count >= MAX_MONSTER_TEMPLATES) {
+            data_error("too many monsters (max %d)", MAX_MONSTER_TEMPLATES);
+            break;
+        }
+
+        MonsterTemplate* t = &monster_templates[monster_count];
+        t->name = data_intern(name);
+        monster_names[monster_count] = t->name;
+        compile_monster(t, name, fields, count);
+        monster_count++;
     }
-    // Parse logic here
     fclose(f);
+
+    resolve_ai_transitions();
+    if (!phash_build(&monster_hash, monster_names, monster_count)) {
+        data_error("could not build name table");
+    }
+    data_end();
     ui_log("Loaded Monsters from %s", filename);
 }
+
+// ----------------------------------------------------------------------------
+// Queries
+// ----------------------------------------------------------------------------
+
+const JobTemplate* data_get_job(JobType j) {
+    if (j < 0 || j >= JOB_MAX) j = JOB_WARRIOR;
+    return &job_templates[j];
+}
+
+int data_find_monster(const char* name) {
+    if (monster_count == 0) return -1;
+    return phash_lookup(&monster_hash, monster_names, name);
+}
+
+int data_monster_count(void) {
+    return monster_count;
+}
+
+const MonsterTemplate* data_get_monster(int index) {
+    if (index < 0 || index >= monster_count) return NULL;
+    return &monster_templates[index];
+}
+
+int data_ai_state_count(void) {
+    return ai_state_count;
+}
+
+const AiStateTemplate* data_get_ai_state(int index) {
+    if (index < 0 || index >= ai_state_count) return NULL;
+    return &ai_states[index];
+}
+
+void data_spawn_monster(int index, Entity* out, EntityID id, int x, int y) {
+    *out = monster_templates[index].proto;
+    out->id = id;
+    out->x = x;
+    out->y = y;
+}
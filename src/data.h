@@ -1,8 +1,76 @@
 #ifndef DATA_H
 #define DATA_H
 
+#include "entity.h"
+
+// Templates
+// data/jobs.txt and data/monsters.txt are parsed once at startup into
+// index-addressed tables. Names are interned and looked up by perfect hash.
+// Malformed files are fatal and report file:line.
+
+#define MAX_MONSTER_TEMPLATES 64
+
+typedef struct {
+    const char* name;     // Interned, e.g. "Warrior"
+    const char* abbr;     // Interned, e.g. "WAR"
+    Attributes mods;      // Added to race base stats
+    int hp_per_level;
+    int mp_per_level;     // 0 = job has no MP pool
+} JobTemplate;
+
+typedef struct {
+    const char* name;     // Interned
+    Entity proto;         // Fully derived instance; spawning copies it
+} MonsterTemplate;
+
+// Behaviours
+// "@Behaviour:STATE=ACTION,..." lines in monsters.txt declare per-archetype
+// state machines, one line per state. States from every behaviour share one
+// flat table; transitions and Entity.ai_state are indices into it.
+#define MAX_AI_STATES 128
+
+typedef enum {
+    AI_ACT_WAIT,         // Idle for TICKS (default: move speed)
+    AI_ACT_WAIT_RANDOM,  // Idle for MIN..MAX ticks
+    AI_ACT_WANDER,       // Step to a random free neighbour; FAIL if boxed in
+    AI_ACT_ENGAGE,       // Engage whoever was noticed; FAIL if they are gone
+    AI_ACT_HOLD,         // Stay while engaged; FAIL once the fight is over
+    AI_ACT_BURROW,       // Dig in and pick a tunnel exit
+    AI_ACT_SURFACE,      // Come up at the tunnel exit
+    AI_ACT_FOLLOW_SCENT, // Step up the smell gradient; FAIL when it runs out
+    AI_ACT_MAX
+} AiAction;
+
+typedef enum {
+    AI_OUT_DONE,
+    AI_OUT_FAIL,
+    AI_OUT_NOTICE, // Perceived a player (see ai_on_stimulus)
+    AI_OUT_MAX
+} AiOutcome;
+
+typedef struct {
+    const char* behaviour; // Interned
+    const char* name;      // Interned
+    AiAction action;
+    int min, max;          // Action parameters in ticks (MIN/MAX, or TICKS for both)
+    int next[AI_OUT_MAX];  // State index per outcome; unset outcomes stay put
+    bool start;            // First state of its behaviour
+} AiStateTemplate;
+
 void data_init_loaders(void);
 void data_load_jobs(const char* filename);
 void data_load_monsters(const char* filename);
 
+const JobTemplate* data_get_job(JobType j);
+
+int data_find_monster(const char* name);   // -1 if unknown
+int data_monster_count(void);
+const MonsterTemplate* data_get_monster(int index);
+
+int data_ai_state_count(void);
+const AiStateTemplate* data_get_ai_state(int index);
+
+// Copies the template into out and sets the per-instance fields
+void data_spawn_monster(int index, Entity* out, EntityID id, int x, int y);
+
 #endif
@@ -0,0 +1,189 @@
+#include <stddef.h>
+#include <limits.h>
+#include "enmity.h"
+#include "turn.h"
+#include "game.h"
+
+// Enmity generated per point of damage / healing
+#define CE_PER_DAMAGE 1
+#define VE_PER_DAMAGE 3
+#define CE_PER_HEAL 1
+#define VE_PER_HEAL 6
+
+// ----------------------------------------------------------------------------
+// Decay Helpers
+// ----------------------------------------------------------------------------
+
+static int ve_at(const EnmityEntry* en, long now) {
+    if (en->ve <= 0 || now <= en->ve_time) return en->ve;
+    long lost = (now - en->ve_time) * ENMITY_VE_DECAY_PER_SEC / TURN_TICKS_PER_SECOND;
+    return lost >= en->ve ? 0 : en->ve - (int)lost;
+}
+
+// Ticks until `amount` of VE has decayed (rounded up)
+static long ticks_to_decay(long amount) {
+    return (amount * TURN_TICKS_PER_SECOND + ENMITY_VE_DECAY_PER_SEC - 1) / ENMITY_VE_DECAY_PER_SEC;
+}
+
+int enmity_total(const EnmityEntry* entry, long now) {
+    return entry->ce + ve_at(entry, now);
+}
+
+// Rebuilds the cached top entry and how long it stays valid.
+// Between VE breakpoints every entry with VE left decays at the same rate, so
+// the order can only change when a decaying entry meets a flat one.
+static void recompute_top(EnmityTable* t, long now) {
+    if (t->count == 0) return;
+
+    int best = t->top < t->count ? t->top : 0; // Prefer current top on ties
+    int best_total = enmity_total(&t->entries[best], now);
+    for (int i = 0; i < t->count; i++) {
+        int total = enmity_total(&t->entries[i], now);
+        if (total > best_total) {
+            best = i;
+            best_total = total;
+        }
+    }
+    t->top = best;
+
+    long until = LONG_MAX;
+    int best_ve = ve_at(&t->entries[best], now);
+    for (int i = 0; i < t->count; i++) {
+        int ve = ve_at(&t->entries[i], now);
+        if (ve > 0) {
+            long breakpoint = now + ticks_to_decay(ve);
+            if (breakpoint < until) until = breakpoint;
+        }
+        if (i != best && best_ve > 0 && ve == 0) {
+            long gap = best_total - enmity_total(&t->entries[i], now);
+            long crossing = now + ticks_to_decay(gap);
+            if (crossing < until) until = crossing;
+        }
+    }
+    t->top_valid_until = until;
+}
+
+// ----------------------------------------------------------------------------
+// Reverse References
+// ----------------------------------------------------------------------------
+
+static void ref_add(Entity* e, EntityID mob_id) {
+    for (int i = 0; i < e->hated_by_count; i++) {
+        if (e->hated_by[i] == mob_id) return;
+    }
+    // Room for every monster in the zone, so a reference is never dropped
+    e->hated_by[e->hated_by_count++] = mob_id;
+}
+
+static void ref_remove(Entity* e, EntityID mob_id) {
+    for (int i = 0; i < e->hated_by_count; i++) {
+        if (e->hated_by[i] == mob_id) {
+            e->hated_by[i] = e->hated_by[--e->hated_by_count];
+            return;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Table Updates
+// ----------------------------------------------------------------------------
+
+static void remove_at(Entity* mob, int idx) {
+    EnmityTable* t = &mob->enmity;
+    Entity* e = game_get_entity(t->entries[idx].id);
+    if (e) ref_remove(e, mob->id);
+
+    t->entries[idx] = t->entries[--t->count];
+    t->top = 0;
+    t->top_valid_until = 0; // Force recompute on next query
+}
+
+static void add_enmity(Entity* mob, Entity* source, int ce, int ve, long now) {
+    EnmityTable* t = &mob->enmity;
+    EnmityEntry* en = NULL;
+
+    for (int i = 0; i < t->count; i++) {
+        if (t->entries[i].id == source->id) {
+            en = &t->entries[i];
+            break;
+        }
+    }
+
+    if (!en) {
+        if (t->count >= ENMITY_MAX_ENTRIES) {
+            // Full: evict the least hated
+            int low = 0;
+            for (int i = 1; i < t->count; i++) {
+                if (enmity_total(&t->entries[i], now) < enmity_total(&t->entries[low], now)) low = i;
+            }
+            remove_at(mob, low);
+        }
+        en = &t->entries[t->count++];
+        en->id = source->id;
+        en->ce = 0;
+        en->ve = 0;
+        en->ve_time = now;
+        ref_add(source, mob->id);
+    }
+
+    // Settle decay up to now before adding
+    en->ve = ve_at(en, now);
+    en->ve_time = now;
+
+    en->ce += ce;
+    en->ve += ve;
+    if (en->ce > ENMITY_CAP) en->ce = ENMITY_CAP;
+    if (en->ve > ENMITY_CAP) en->ve = ENMITY_CAP;
+
+    recompute_top(t, now);
+}
+
+void enmity_on_damage(Entity* mob, Entity* attacker, int damage, long now) {
+    if (!mob || !attacker || damage <= 0 || mob == attacker) return;
+    add_enmity(mob, attacker, damage * CE_PER_DAMAGE, damage * VE_PER_DAMAGE, now);
+}
+
+void enmity_on_heal(Entity* healer, Entity* healed, int amount, long now) {
+    if (!healer || !healed || amount <= 0) return;
+
+    // Only the monsters that already hate the healed entity notice
+    for (int i = 0; i < healed->hated_by_count; i++) {
+        Entity* mob = game_get_entity(healed->hated_by[i]);
+        if (!mob || !mob->is_active) continue;
+        add_enmity(mob, healer, amount * CE_PER_HEAL, amount * VE_PER_HEAL, now);
+    }
+}
+
+EntityID enmity_top(Entity* mob, long now) {
+    EnmityTable* t = &mob->enmity;
+    if (t->count == 0) return -1;
+    if (now >= t->top_valid_until) recompute_top(t, now);
+    return t->entries[t->top].id;
+}
+
+void enmity_remove(Entity* mob, EntityID id) {
+    EnmityTable* t = &mob->enmity;
+    for (int i = 0; i < t->count; i++) {
+        if (t->entries[i].id == id) {
+            remove_at(mob, i);
+            return;
+        }
+    }
+}
+
+void enmity_clear(Entity* mob) {
+    while (mob->enmity.count > 0) {
+        remove_at(mob, mob->enmity.count - 1);
+    }
+}
+
+void enmity_forget(Entity* e) {
+    while (e->hated_by_count > 0) {
+        EntityID mob_id = e->hated_by[e->hated_by_count - 1];
+        Entity* mob = game_get_entity(mob_id);
+        if (mob) enmity_remove(mob, e->id); // Also drops the ref
+        if (e->hated_by_count > 0 && e->hated_by[e->hated_by_count - 1] == mob_id) {
+            e->hated_by_count--; // Mob already gone
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef ENMITY_H
+#define ENMITY_H
+
+#include "entity.h"
+
+// Enmity (Hate) Tables
+// Each monster tracks Cumulative (CE) and Volatile (VE) enmity per attacker.
+// VE decays with game time; decay is applied lazily when entries are read.
+// The top-hate target is cached together with the tick until which it is
+// guaranteed to stay on top, so queries are O(1) between updates.
+
+#define ENMITY_CAP 10000             // Per CE/VE value
+#define ENMITY_VE_DECAY_PER_SEC 60   // VE lost per second (see TURN_TICKS_PER_SECOND)
+
+// Damage dealt to mob by attacker
+void enmity_on_damage(Entity* mob, Entity* attacker, int damage, long now);
+
+// Healing generates enmity on every monster that hates the healed entity
+void enmity_on_heal(Entity* healer, Entity* healed, int amount, long now);
+
+// Highest total enmity, or -1 if the list is empty
+EntityID enmity_top(Entity* mob, long now);
+
+int enmity_total(const EnmityEntry* entry, long now);
+void enmity_remove(Entity* mob, EntityID id);
+
+// mob despawned or died: drop its whole list
+void enmity_clear(Entity* mob);
+
+// e died or left the zone: remove it from every list it appears on
+void enmity_forget(Entity* e);
+
+#endif
@@ -3,7 +3,9 @@
 #include "entity.h"
 #include <string.h>
 #include "entity.h"
-#include "ui.h" // For logging
+#include "evlog.h"
+#include "turn.h"
+#include "data.h"
 
 static const Attributes RACE_BASE[RACE_MAX] = {
     //              STR, DEX, VIT, AGI, INT, MND, CHR
@@ -15,16 +17,7 @@ static const Attributes RACE_BASE[RACE_MAX] = {
     [RACE_WORM]     = {8,  8,  8,  8,  8,  8,  8}
 };
 
-static const Attributes JOB_MODS[JOB_MAX] = {
-    //                STR, DEX, VIT, AGI, INT, MND, CHR
-    [JOB_WARRIOR]    = {3,  1,  3,  1,  0,  0,  0},
-    [JOB_MONK]       = {2,  1,  4,  0,  0,  1,  0},
-    [JOB_THIEF]      = {1,  4,  1,  4,  0,  0,  0},
-    [JOB_BLACK_MAGE] = {0,  0,  1,  1,  5,  2,  1},
-    [JOB_WHITE_MAGE] = {1,  0,  1,  1,  1,  5,  2},
-    [JOB_RED_MAGE]   = {2,  2,  2,  2,  2,  2,  2},
-    [JOB_WORM]       = {0,0,0,0,0,0,0}
-};
+// Job modifiers and growth come from data/jobs.txt (see data.h)
 
 void entity_add_exp(Entity* e, int amount) {
     if (e->type != ENTITY_PLAYER) return; // Simple for now
@@ -39,9 +32,10 @@ void entity_add_exp(Entity* e, int amount) {
         e->job_exp[e->main_job] -= 100;
         e->job_levels[e->main_job]++;
         e->current_level = e->job_levels[e->main_job];
+        entity_mark_dirty(e);
         
-        ui_log("%s is now Level %d %s!", e->name, e->current_level, 
-            e->main_job == JOB_WARRIOR ? "Warrior" : "Adventurer");
+        evlog_3(EVLOG_LEVEL_UP, evlog_entity_name(e), e->current_level,
+            evlog_intern(e->main_job == JOB_WARRIOR ? "Warrior" : "Adventurer"));
     }
 }
 
@@ -50,83 +44,315 @@ bool entity_has_key_item(const Entity* e, KeyItemType ki) {
     return e->key_items[ki] > 0;
 }
 
+// ----------------------------------------------------------------------------
+// Status Effects
+// ----------------------------------------------------------------------------
+// Each effect owns one scheduled expiry event (and a pulse event if periodic).
+// Applying costs one insert, refreshing reschedules the existing event, and
+// nothing is polled per move.
+
+// Ticks between periodic pulses (0 = not periodic)
+static const int STATUS_PULSE_INTERVAL[STATUS_MAX] = {
+    [STATUS_POISON] = 300,
+};
+
+static const char* STATUS_NAMES[STATUS_MAX] = {
+    [STATUS_NONE]      = "None",
+    [STATUS_PROTECT]   = "Protect",
+    [STATUS_POISON]    = "Poison",
+    [STATUS_PARALYSIS] = "Paralysis",
+    [STATUS_WEAKNESS]  = "Weakness",
+};
+
+static int status_index(const Entity* e, StatusEffectType type) {
+    for (int i=0; i < e->effect_count; i++) {
+        if (e->effects[i].type == type) return i;
+    }
+    return -1;
+}
+
+static void status_remove_at(Entity* e, int idx) {
+    turn_cancel(e->effects[idx].expire_event);
+    turn_cancel(e->effects[idx].tick_event);
+
+    // Remove by swap with last
+    e->effects[idx] = e->effects[e->effect_count - 1];
+    e->effect_count--;
+    entity_mark_dirty(e);
+}
+
+const StatusEffect* entity_find_status(const Entity* e, StatusEffectType type) {
+    int idx = status_index(e, type);
+    return idx >= 0 ? &e->effects[idx] : NULL;
+}
+
 void entity_add_status(Entity* e, StatusEffectType type, int duration, int power) {
+    if (type <= STATUS_NONE || type >= STATUS_MAX || duration <= 0) return;
+
+    long now = turn_get_current_time();
+    long expires_at = now + duration;
+
     // Check existing
-    for (int i=0; i < e->effect_count; i++) {
-        if (e->effects[i].type == type) {
-             // Overwrite if stronger or refresh duration
-             // Simple rule: always overwrite for now
-             e->effects[i].duration = duration;
-             e->effects[i].power = power;
-             return;
+    int idx = status_index(e, type);
+    if (idx >= 0) {
+        // Overwrite if stronger or refresh duration
+        // Simple rule: always overwrite for now
+        StatusEffect* fx = &e->effects[idx];
+        fx->expires_at = expires_at;
+        if (fx->power != power) {
+            fx->power = power;
+            entity_mark_dirty(e);
+        }
+        if (!turn_reschedule(fx->expire_event, expires_at)) {
+            fx->expire_event = turn_add_event_data(expires_at, e->id, EVENT_STATUS_EXPIRE, type);
         }
+        // Pulse cadence carries on from the original application
+        if (STATUS_PULSE_INTERVAL[type] > 0 && !turn_event_pending(fx->tick_event)) {
+            fx->tick_event = turn_add_event_data(now + STATUS_PULSE_INTERVAL[type], e->id, EVENT_STATUS_TICK, type);
+        }
+        return;
     }
-    
+
     // Add new
-    if (e->effect_count < 16) {
-        e->effects[e->effect_count].type = type;
-        e->effects[e->effect_count].duration = duration;
-        e->effects[e->effect_count].power = power;
-        e->effect_count++;
+    if (e->effect_count >= MAX_STATUS_EFFECTS) return;
+
+    StatusEffect* fx = &e->effects[e->effect_count++];
+    fx->type = type;
+    fx->expires_at = expires_at;
+    fx->power = power;
+    fx->expire_event = turn_add_event_data(expires_at, e->id, EVENT_STATUS_EXPIRE, type);
+    fx->tick_event = EVENT_HANDLE_NONE;
+    if (STATUS_PULSE_INTERVAL[type] > 0) {
+        fx->tick_event = turn_add_event_data(now + STATUS_PULSE_INTERVAL[type], e->id, EVENT_STATUS_TICK, type);
+    }
+    entity_mark_dirty(e);
+
+    if (e->is_active && e->type == ENTITY_PLAYER) {
+        evlog_2(EVLOG_STATUS_GAIN, evlog_entity_name(e), evlog_intern(STATUS_NAMES[type]));
     }
 }
 
-void entity_tick_status(Entity* e) {
-    if (!e->is_active) return;
-    
-    for (int i=0; i < e->effect_count; i++) {
-        if (e->effects[i].type != STATUS_NONE) {
-            e->effects[i].duration--;
-            
-            if (e->effects[i].duration <= 0) {
-                 // Expired
-                 // ui_log("%s's effect wears off.", e->name); // Optional spam
-                 
-                 // Remove by swap with last
-                 e->effects[i] = e->effects[e->effect_count - 1];
-                 e->effect_count--;
-                 i--; // Revisit this index since we swapped
-            }
+void entity_requeue_status(Entity* e) {
+    long now = turn_get_current_time();
+    for (int i = 0; i < e->effect_count; i++) {
+        StatusEffect* fx = &e->effects[i];
+        if (fx->expires_at < now) fx->expires_at = now;
+        fx->expire_event = turn_add_event_data(fx->expires_at, e->id, EVENT_STATUS_EXPIRE, fx->type);
+        fx->tick_event = EVENT_HANDLE_NONE;
+        long next = now + STATUS_PULSE_INTERVAL[fx->type];
+        if (STATUS_PULSE_INTERVAL[fx->type] > 0 && next <= fx->expires_at) {
+            fx->tick_event = turn_add_event_data(next, e->id, EVENT_STATUS_TICK, fx->type);
         }
     }
 }
 
+void entity_remove_status(Entity* e, StatusEffectType type) {
+    int idx = status_index(e, type);
+    if (idx >= 0) status_remove_at(e, idx);
+}
+
+void entity_expire_status(Entity* e, StatusEffectType type) {
+    int idx = status_index(e, type);
+    if (idx < 0) return;
+    if (e->effects[idx].expires_at > turn_get_current_time()) return; // Refreshed since queued
+
+    if (e->is_active && e->type == ENTITY_PLAYER) {
+        evlog_2(EVLOG_STATUS_WEAR, evlog_entity_name(e), evlog_intern(STATUS_NAMES[type]));
+    }
+    status_remove_at(e, idx);
+}
+
+bool entity_pulse_status(Entity* e, StatusEffectType type) {
+    int idx = status_index(e, type);
+    if (idx < 0 || !e->is_active) return false;
+
+    StatusEffect* fx = &e->effects[idx];
+    long now = turn_get_current_time();
+
+    switch (type) {
+        case STATUS_POISON:
+            e->resources.hp -= fx->power;
+            if (e->resources.hp < 0) e->resources.hp = 0;
+            evlog_2(EVLOG_POISON, evlog_entity_name(e), fx->power);
+            break;
+        default:
+            break;
+    }
+    fx->tick_event = EVENT_HANDLE_NONE; // This pulse just fired
+    if (e->resources.hp == 0) {
+        evlog_3(EVLOG_STATUS_DEFEAT, evlog_entity_name(e), evlog_intern(STATUS_NAMES[type]), e->id);
+        return true; // The caller runs the defeat
+    }
+
+    // Queue the next pulse if the effect is still running by then
+    long next = now + STATUS_PULSE_INTERVAL[type];
+    if (STATUS_PULSE_INTERVAL[type] > 0 && next <= fx->expires_at) {
+        fx->tick_event = turn_add_event_data(next, e->id, EVENT_STATUS_TICK, type);
+    }
+    return false;
+}
+
 // Helpers Stubs
 void entity_init_stats(Entity* e, RaceType r, JobType j) {
     if (r < 0 || r >= RACE_MAX) r = RACE_HUME; // Safety
     if (j < 0 || j >= JOB_MAX) j = JOB_WARRIOR;
     
+    const Attributes* mods = &data_get_job(j)->mods;
+
     // 1. Calculate Base
-    e->base_stats.str = RACE_BASE[r].str + JOB_MODS[j].str;
-    e->base_stats.dex = RACE_BASE[r].dex + JOB_MODS[j].dex;
-    e->base_stats.vit = RACE_BASE[r].vit + JOB_MODS[j].vit;
-    e->base_stats.agi = RACE_BASE[r].agi + JOB_MODS[j].agi;
-    e->base_stats.intel = RACE_BASE[r].intel + JOB_MODS[j].intel;
-    e->base_stats.mnd = RACE_BASE[r].mnd + JOB_MODS[j].mnd;
-    e->base_stats.chr = RACE_BASE[r].chr + JOB_MODS[j].chr;
+    e->base_stats.str = RACE_BASE[r].str + mods->str;
+    e->base_stats.dex = RACE_BASE[r].dex + mods->dex;
+    e->base_stats.vit = RACE_BASE[r].vit + mods->vit;
+    e->base_stats.agi = RACE_BASE[r].agi + mods->agi;
+    e->base_stats.intel = RACE_BASE[r].intel + mods->intel;
+    e->base_stats.mnd = RACE_BASE[r].mnd + mods->mnd;
+    e->base_stats.chr = RACE_BASE[r].chr + mods->chr;
     
-    // 2. Sync Current
-    e->current_stats = e->base_stats;
+    // 2. Resources (Level 1 pools)
+    e->base_hp = (e->base_stats.vit * 5) + (e->base_stats.str * 2);
     
-    // 3. Resources
-    e->resources.max_hp = (e->base_stats.vit * 5) + (e->base_stats.str * 2);
-    
-    if (j == JOB_WARRIOR || j == JOB_MONK || j == JOB_THIEF) {
-        e->resources.max_mp = 0;
+    if (data_get_job(j)->mp_per_level <= 0) {
+        e->base_mp = 0;
     } else {
-        e->resources.max_mp = (e->base_stats.intel * 3) + (e->base_stats.mnd * 2);
+        e->base_mp = (e->base_stats.intel * 3) + (e->base_stats.mnd * 2);
     }
     
-    // Fill
-    e->resources.hp = e->resources.max_hp;
-    e->resources.mp = e->resources.max_mp;
-    
-    // 4. Set Fields
+    // 3. Set Fields
     e->race = r;
     e->main_job = j;
     e->current_level = 1; 
     e->job_levels[j] = 1;
     e->job_exp[j] = 0;
+
+    // 4. Derive & Fill
+    entity_mark_dirty(e);
+    entity_refresh_stats(e);
+    e->resources.hp = e->resources.max_hp;
+    e->resources.mp = e->resources.max_mp;
+}
+
+// ----------------------------------------------------------------------------
+// Derived Stats
+// ----------------------------------------------------------------------------
+
+#define DEFAULT_DELAY 100
+
+// Entities waiting for a recompute. Flushed in one pass before combat.
+// Per-thread, like the scheduler.
+#define MAX_DIRTY_ENTITIES 256
+static __thread Entity* dirty_queue[MAX_DIRTY_ENTITIES];
+static __thread int dirty_count = 0;
+
+static void entity_recompute_stats(Entity* e) {
+    int level = e->current_level > 0 ? e->current_level : 1;
+    int growth = (level - 1) / 2;
+    const JobTemplate* job = data_get_job(e->main_job);
+
+    // 1. Attributes: Base + Level + Gear
+    Attributes a = e->base_stats;
+    a.str += growth + e->gear_stats.str;
+    a.dex += growth + e->gear_stats.dex;
+    a.vit += growth + e->gear_stats.vit;
+    a.agi += growth + e->gear_stats.agi;
+    a.intel += growth + e->gear_stats.intel;
+    a.mnd += growth + e->gear_stats.mnd;
+    a.chr += growth + e->gear_stats.chr;
+
+    // 2. Buffs / Debuffs
+    int protect = 0;
+    int paralysis = 0;
+    for (int i=0; i < e->effect_count; i++) {
+        const StatusEffect* fx = &e->effects[i];
+        switch (fx->type) {
+            case STATUS_PROTECT: protect += fx->power; break;
+            case STATUS_PARALYSIS: paralysis += fx->power; break;
+            case STATUS_WEAKNESS:
+                a.str -= fx->power; a.dex -= fx->power; a.vit -= fx->power;
+                a.agi -= fx->power; a.intel -= fx->power; a.mnd -= fx->power;
+                a.chr -= fx->power;
+                break;
+            default: break;
+        }
+    }
+    if (a.str < 1) a.str = 1;
+    if (a.dex < 1) a.dex = 1;
+    if (a.vit < 1) a.vit = 1;
+    if (a.agi < 1) a.agi = 1;
+    if (a.intel < 1) a.intel = 1;
+    if (a.mnd < 1) a.mnd = 1;
+    if (a.chr < 1) a.chr = 1;
+    e->current_stats = a;
+
+    // 3. Combat values
+    e->derived.attack = a.str * 2;
+    e->derived.defense = a.vit * 2 + protect;
+    e->derived.delay = (e->weapon_delay > 0 ? e->weapon_delay : DEFAULT_DELAY) + paralysis;
+
+    // 4. Pools: Level 1 pool + growth + attribute deltas
+    const Attributes* b = &e->base_stats;
+    e->derived.max_hp = e->base_hp + (level - 1) * job->hp_per_level
+                      + (a.vit - b->vit) * 5 + (a.str - b->str) * 2;
+    if (e->derived.max_hp < 1) e->derived.max_hp = 1;
+
+    e->derived.max_mp = 0;
+    if (e->base_mp > 0) {
+        e->derived.max_mp = e->base_mp + (level - 1) * job->mp_per_level
+                          + (a.intel - b->intel) * 3 + (a.mnd - b->mnd) * 2;
+        if (e->derived.max_mp < 0) e->derived.max_mp = 0;
+    }
+
+    e->resources.max_hp = e->derived.max_hp;
+    e->resources.max_mp = e->derived.max_mp;
+    if (e->resources.hp > e->resources.max_hp) e->resources.hp = e->resources.max_hp;
+    if (e->resources.mp > e->resources.max_mp) e->resources.mp = e->resources.max_mp;
+
+    e->stats_dirty = false;
+}
+
+void entity_mark_dirty(Entity* e) {
+    if (e->stats_dirty) return; // Already queued
+
+    if (dirty_count >= MAX_DIRTY_ENTITIES) {
+        entity_recompute_stats(e); // Queue full, pay now
+        return;
+    }
+    e->stats_dirty = true;
+    dirty_queue[dirty_count++] = e;
+}
+
+void entity_refresh_stats(Entity* e) {
+    if (e->stats_dirty) entity_recompute_stats(e);
+}
+
+void entity_flush_dirty_stats(void) {
+    for (int i = 0; i < dirty_count; i++) {
+        entity_refresh_stats(dirty_queue[i]);
+    }
+    dirty_count = 0;
+}
+
+void entity_set_job(Entity* e, JobType j) {
+    if (j < 0 || j >= JOB_MAX || e->main_job == j) return;
+    e->main_job = j;
+    if (e->job_levels[j] < 1) e->job_levels[j] = 1;
+    e->current_level = e->job_levels[j];
+    entity_mark_dirty(e);
+}
+
+void entity_set_level(Entity* e, int level) {
+    if (level < 1) level = 1;
+    if (e->current_level == level) return;
+    e->job_levels[e->main_job] = level;
+    e->current_level = level;
+    entity_mark_dirty(e);
+}
+
+void entity_set_gear(Entity* e, const Attributes* stats, int damage, int delay) {
+    if (stats) e->gear_stats = *stats;
+    else memset(&e->gear_stats, 0, sizeof(Attributes));
+    e->weapon_damage = damage;
+    e->weapon_delay = delay;
+    entity_mark_dirty(e);
 }
 
 const char* entity_get_race_name(RaceType r) {
@@ -154,35 +380,21 @@ const char* entity_get_race_name_short(RaceType r) {
 }
 
 const char* entity_get_job_name(JobType j) {
-     switch (j) {
-        case JOB_WARRIOR: return "Warrior";
-        case JOB_MONK: return "Monk";
-        case JOB_THIEF: return "Thief";
-        case JOB_BLACK_MAGE: return "Black MAge";
-        case JOB_WHITE_MAGE: return "White Mage";
-        case JOB_RED_MAGE: return "Red Mage";
-        default: return "???";
-    }
+    if (j < 0 || j >= JOB_MAX || !data_get_job(j)->name) return "???";
+    return data_get_job(j)->name;
 }
 
 const char* entity_get_job_name_short(JobType j) {
-     switch (j) {
-        case JOB_WARRIOR: return "WAR";
-        case JOB_MONK: return "MNK";
-        case JOB_THIEF: return "THF";
-        case JOB_BLACK_MAGE: return "BLM";
-        case JOB_WHITE_MAGE: return "WHM";
-        case JOB_RED_MAGE: return "RDM";
-        default: return "???";
-    }
+    if (j < 0 || j >= JOB_MAX || !data_get_job(j)->abbr) return "???";
+    return data_get_job(j)->abbr;
 }
 
 int entity_get_derived_attack(const Entity* e) {
-    return e->current_stats.str * 2; // Stub
+    return e->derived.attack;
 }
 
 int entity_get_derived_defense(const Entity* e) {
-    return e->current_stats.vit * 2; // Stub
+    return e->derived.defense;
 }
 
 int entity_get_tnl(int level) {
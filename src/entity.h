@@ -47,13 +47,12 @@ typedef enum {
     ENTITY_ENEMY
 } EntityType;
 
+// AI level of detail, by distance from the player (see ai.c)
 typedef enum {
-    AI_IDLE,
-    AI_WANDER,
-    AI_ENGAGED,
-    AI_BURROWING,
-    AI_WORM_TRAVEL
-} AIState;
+    AI_LOD_ACTIVE,  // Full rate
+    AI_LOD_COARSE,  // Acts at a fraction of the rate
+    AI_LOD_DORMANT  // Asleep in a sector list, no events queued
+} AILod;
 
 // Detection Flags
 #define DETECT_SIGHT (1 << 0)
@@ -74,13 +73,22 @@ typedef enum {
     STATUS_PROTECT,
     STATUS_POISON,
     STATUS_PARALYSIS,
-    STATUS_WEAKNESS
+    STATUS_WEAKNESS,
+    STATUS_MAX
 } StatusEffectType;
 
+// Handle to a scheduled event (see turn.h)
+typedef int EventHandle;
+#define EVENT_HANDLE_NONE (-1)
+
+#define MAX_STATUS_EFFECTS 16
+
 typedef struct {
     StatusEffectType type;
-    int duration; // Turns/Ticks
-    int power;    // Magnitude
+    long expires_at;          // Absolute game time (ticks) the effect wears off
+    int power;                // Magnitude
+    EventHandle expire_event; // Scheduled EVENT_STATUS_EXPIRE
+    EventHandle tick_event;   // Scheduled EVENT_STATUS_TICK (periodic effects only)
 } StatusEffect;
 
 typedef struct {
@@ -102,15 +110,45 @@ typedef struct {
     int max_tp;  // Usually 3000
 } Resources;
 
+// Derived combat values, recomputed in batch when the entity is marked dirty
+typedef struct {
+    int attack;
+    int defense;
+    int max_hp;
+    int max_mp;
+    int delay;   // Ticks between auto-attacks
+} DerivedStats;
+
 // Forward declaration for combat target
 // We use IDs instead of pointers to avoid dangling pointer issues if an entity dies/respawns
 typedef int EntityID; 
 
+// Enmity (Hate)
+// Monsters keep a compact hate list of who has hurt them. Volatile enmity decays
+// over time and is evaluated lazily (see enmity.h).
+#define ENMITY_MAX_ENTRIES 8
+#define ENMITY_MAX_REFS 100 // Every monster in a zone (MAX_ENTITIES, checked in game.h)
+
+typedef struct {
+    EntityID id;
+    int ce;         // Cumulative enmity
+    int ve;         // Volatile enmity as of ve_time
+    long ve_time;
+} EnmityEntry;
+
+typedef struct {
+    EnmityEntry entries[ENMITY_MAX_ENTRIES];
+    int count;
+    int top;               // Cached index of the highest total (when count > 0)
+    long top_valid_until;  // Cached top is exact until this tick
+} EnmityTable;
+
 typedef struct {
     EntityID id;
     EntityType type; // Player or Enemy
     int x, y;
     char name[MAX_NAME_LEN];
+    int name_id;     // Event log name id, 0 until first logged (reset when renamed)
     char symbol;
     int color_pair;
     
@@ -125,15 +163,28 @@ typedef struct {
     int job_exp[JOB_MAX];
 
     Attributes base_stats;    // Permanent stats
+    Attributes gear_stats;    // Flat bonuses from equipment
     Attributes current_stats; // Calculated (Base + Job + Gear + Buffs)
     Resources resources;
+    int base_hp;              // Level 1 pools before growth and modifiers
+    int base_mp;
+
+    // Cached derived values. Never read these while stats_dirty is set;
+    // entity_flush_dirty_stats() runs before every combat resolution.
+    DerivedStats derived;
+    bool stats_dirty;
 
     // Progression / State
     uint8_t key_items[KI_MAX]; // 0=Locked, 1=Owned
     EntityID claimed_by;       // -1 if unclaimed
+
+    // Enmity
+    EnmityTable enmity;                 // Who this entity hates (monsters)
+    EntityID hated_by[ENMITY_MAX_REFS]; // Monsters with this entity on their list
+    int hated_by_count;
     
     // Status Effects
-    StatusEffect effects[16];
+    StatusEffect effects[MAX_STATUS_EFFECTS];
     int effect_count;
 
     // Combat State
@@ -141,6 +192,8 @@ typedef struct {
     EntityID target_id;
     int weapon_delay;     // Base delay for auto-attacks
     int weapon_damage;    // Base damage
+    int poison_power;     // Poison inflicted on hit, per pulse (0 = none)
+    EventHandle attack_event; // Pending EVENT_ATTACK_READY
     
     // Respawn Logic
     bool is_active;       // If false, it's a "tombstone" waiting to respawn
@@ -150,7 +203,11 @@ typedef struct {
     int move_speed;       // Ticks per tile (Default 100)
     bool is_aggressive;
     uint8_t detection_flags;
-    AIState ai_state;
+    int ai_state;         // Behaviour state (see data.h), -1 = no behaviour
+    AILod ai_lod;
+    int lod_next;         // Next sleeper in the same sector (entity index + 1, 0 = end)
+    int spatial_cell;     // Spatial grid cell + 1, 0 = not indexed
+    int spatial_next;     // Next entity in the same cell (entity index + 1, 0 = end)
     
     // Worm Specific
     bool is_burrowed;
@@ -162,10 +219,29 @@ typedef struct {
 // Helper Functions
 void entity_add_exp(Entity* e, int amount);
 bool entity_has_key_item(const Entity* e, KeyItemType ki);
+
+// Status Effects
+// Durations are in ticks. Expiry and periodic pulses are driven by the scheduler.
 void entity_add_status(Entity* e, StatusEffectType type, int duration, int power);
-void entity_tick_status(Entity* e);
+void entity_remove_status(Entity* e, StatusEffectType type);
+void entity_expire_status(Entity* e, StatusEffectType type);  // EVENT_STATUS_EXPIRE handler
+bool entity_pulse_status(Entity* e, StatusEffectType type);   // EVENT_STATUS_TICK handler; true if it took the last HP
+const StatusEffect* entity_find_status(const Entity* e, StatusEffectType type);
+// Queues the expiry and pulses of every effect again, after turn_clear() dropped them
+void entity_requeue_status(Entity* e);
+
 void entity_init_stats(Entity* e, RaceType r, JobType j);
 
+// Derived Stats
+// Anything that changes race, job, level, gear or status effects marks the entity
+// dirty. Dirty entities are recomputed once, in batch, by entity_flush_dirty_stats().
+void entity_mark_dirty(Entity* e);
+void entity_refresh_stats(Entity* e);
+void entity_flush_dirty_stats(void);
+void entity_set_job(Entity* e, JobType j);
+void entity_set_level(Entity* e, int level);
+void entity_set_gear(Entity* e, const Attributes* stats, int damage, int delay);
+
 // Stubs
 const char* entity_get_race_name(RaceType r);
 const char* entity_get_job_name(JobType j);
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <string.h>
+#include "evlog.h"
+#include "turn.h"
+
+#define EVLOG_MASK (EVLOG_CAPACITY - 1)
+
+// Ring
+// Writers claim an index with one atomic add, fill the slot, then publish it by
+// storing seq = index + 1. A slot reused by a later lap is caught by readers
+// because its seq no longer matches (seqlock style double check).
+static EvlogRecord ring[EVLOG_CAPACITY];
+static uint64_t write_pos = 0;
+static bool enabled = false;
+
+// Names
+// Append-only table; id 0 is reserved for "not interned".
+#define NAME_HASH_SIZE 1024 // Power of two, > 2x EVLOG_MAX_NAMES
+static char names[EVLOG_MAX_NAMES][MAX_NAME_LEN];
+static int name_count = 1;
+static int16_t name_hash[NAME_HASH_SIZE]; // Open addressing, 0 = empty
+static bool name_lock = false;
+
+// Sink
+static FILE* sink = NULL;
+static uint64_t flushed_pos = 0;
+static int names_flushed = 1;
+static long dropped = 0;
+
+// ----------------------------------------------------------------------------
+// Setup
+// ----------------------------------------------------------------------------
+
+void evlog_init(const char* sink_path) {
+    memset(ring, 0, sizeof(ring));
+    write_pos = 0;
+    flushed_pos = 0;
+    dropped = 0;
+
+    if (sink_path) {
+        sink = fopen(sink_path, "wb");
+        if (sink) {
+            EvlogFileHeader h;
+            memset(&h, 0, sizeof(h));
+            memcpy(h.magic, EVLOG_MAGIC, sizeof(EVLOG_MAGIC));
+            h.version = EVLOG_VERSION;
+            h.record_size = sizeof(EvlogRecord);
+            fwrite(&h, sizeof(h), 1, sink);
+            names_flushed = 1;
+        }
+    }
+    evlog_set_enabled(true);
+}
+
+void evlog_shutdown(void) {
+    evlog_flush();
+    if (sink) {
+        if (dropped > 0) fprintf(stderr, "evlog: %ld records overwritten before reaching disk\n", dropped);
+        fclose(sink);
+        sink = NULL;
+    }
+    evlog_set_enabled(false);
+}
+
+void evlog_set_enabled(bool on) {
+    __atomic_store_n(&enabled, on, __ATOMIC_RELAXED);
+}
+
+// ----------------------------------------------------------------------------
+// Writers
+// ----------------------------------------------------------------------------
+
+// Claims count adjacent indices
+static uint64_t claim_records(int count) {
+    return __atomic_fetch_add(&write_pos, (uint64_t)count, __ATOMIC_RELAXED);
+}
+
+static EvlogRecord* begin_record(EvlogCode code, uint64_t idx) {
+    EvlogRecord* rec = &ring[idx & EVLOG_MASK];
+
+    // Mark in-flight before touching the payload
+    __atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    rec->code = (uint16_t)code;
+    rec->aux = 0;
+    rec->tick = turn_get_current_time();
+    return rec;
+}
+
+static void publish_record(EvlogRecord* rec, uint64_t idx) {
+    __atomic_store_n(&rec->seq, (uint32_t)(idx + 1), __ATOMIC_RELEASE);
+}
+
+void evlog_emit(EvlogCode code, int argc, const int32_t* args) {
+    if (!__atomic_load_n(&enabled, __ATOMIC_RELAXED)) return;
+    if (argc > EVLOG_MAX_ARGS) argc = EVLOG_MAX_ARGS;
+
+    uint64_t idx = claim_records(1);
+    EvlogRecord* rec = begin_record(code, idx);
+    for (int i = 0; i < argc; i++) rec->args[i] = args[i];
+    publish_record(rec, idx);
+}
+
+void evlog_text(const char* text) {
+    if (!__atomic_load_n(&enabled, __ATOMIC_RELAXED)) return;
+
+    // Split into record-sized pieces, breaking at the last space that fits
+    const char* piece[EVLOG_TEXT_MAX_RECORDS];
+    int piece_len[EVLOG_TEXT_MAX_RECORDS];
+    int count = 0;
+    size_t left = strlen(text);
+    while (count < EVLOG_TEXT_MAX_RECORDS) {
+        int len = (int)left;
+        if (left > EVLOG_TEXT_LEN - 1) {
+            len = EVLOG_TEXT_LEN - 1;
+            for (int i = len; i > 0; i--) {
+                if (text[i] == ' ') {
+                    len = i;
+                    break;
+                }
+            }
+        }
+        piece[count] = text;
+        piece_len[count++] = len;
+        text += len;
+        left -= (size_t)len;
+        while (*text == ' ') {
+            text++;
+            left--;
+        }
+        if (left == 0) break;
+    }
+
+    // Claimed together so a continuation always follows its head
+    uint64_t idx = claim_records(count);
+    for (int i = 0; i < count; i++) {
+        EvlogRecord* rec = begin_record(i == 0 ? EVLOG_TEXT : EVLOG_TEXT_MORE, idx + i);
+        memcpy(rec->text, piece[i], (size_t)piece_len[i]);
+        rec->text[piece_len[i]] = '\0';
+        publish_record(rec, idx + i);
+    }
+}
+
+void evlog_1(EvlogCode code, int32_t a) {
+    evlog_emit(code, 1, &a);
+}
+
+void evlog_2(EvlogCode code, int32_t a, int32_t b) {
+    int32_t args[2] = {a, b};
+    evlog_emit(code, 2, args);
+}
+
+void evlog_3(EvlogCode code, int32_t a, int32_t b, int32_t c) {
+    int32_t args[3] = {a, b, c};
+    evlog_emit(code, 3, args);
+}
+
+void evlog_4(EvlogCode code, int32_t a, int32_t b, int32_t c, int32_t d) {
+    int32_t args[4] = {a, b, c, d};
+    evlog_emit(code, 4, args);
+}
+
+// ----------------------------------------------------------------------------
+// Names
+// ----------------------------------------------------------------------------
+
+static uint32_t hash_name(const char* s) {
+    uint32_t h = 2166136261u; // FNV-1a
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+int evlog_intern(const char* name) {
+    uint32_t h = hash_name(name);
+
+    while (__atomic_test_and_set(&name_lock, __ATOMIC_ACQUIRE)) {
+        // Spin: interning is rare (once per entity name)
+    }
+
+    int id = 0;
+    for (uint32_t i = 0; i < NAME_HASH_SIZE; i++) {
+        int slot = (h + i) & (NAME_HASH_SIZE - 1);
+        int cur = name_hash[slot];
+        if (cur == 0) {
+            if (name_count < EVLOG_MAX_NAMES) {
+                id = name_count;
+                strncpy(names[id], name, MAX_NAME_LEN - 1);
+                name_hash[slot] = (int16_t)id;
+                __atomic_store_n(&name_count, id + 1, __ATOMIC_RELEASE);
+            }
+            break;
+        }
+        if (strcmp(names[cur], name) == 0) {
+            id = cur;
+            break;
+        }
+    }
+
+    __atomic_clear(&name_lock, __ATOMIC_RELEASE);
+    return id; // 0 when the table is full; formats as "?"
+}
+
+int evlog_entity_name(Entity* e) {
+    if (e->name_id == 0) {
+        if (!__atomic_load_n(&enabled, __ATOMIC_RELAXED)) return 0; // Record is dropped anyway
+        e->name_id = evlog_intern(e->name);
+    }
+    return e->name_id;
+}
+
+void evlog_define_name(int id, const char* name) {
+    if (id <= 0 || id >= EVLOG_MAX_NAMES) return;
+    strncpy(names[id], name, MAX_NAME_LEN - 1);
+    names[id][MAX_NAME_LEN - 1] = '\0';
+    if (id >= name_count) name_count = id + 1;
+}
+
+const char* evlog_name(int id) {
+    int count = __atomic_load_n(&name_count, __ATOMIC_ACQUIRE);
+    if (id <= 0 || id >= count) return "?";
+    return names[id];
+}
+
+// ----------------------------------------------------------------------------
+// Readers
+// ----------------------------------------------------------------------------
+
+uint64_t evlog_head(void) {
+    return __atomic_load_n(&write_pos, __ATOMIC_ACQUIRE);
+}
+
+bool evlog_read(uint64_t idx, EvlogRecord* out) {
+    const EvlogRecord* rec = &ring[idx & EVLOG_MASK];
+    uint32_t want = (uint32_t)(idx + 1);
+
+    if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != want) return false;
+    memcpy(out, rec, sizeof(EvlogRecord));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&rec->seq, __ATOMIC_RELAXED) == want; // Not overwritten mid-copy
+}
+
+// Message templates: %n = name arg, %d = int arg (consumed in order)
+static const char* FORMATS[EVLOG_CODE_MAX] = {
+    [EVLOG_TEXT] = NULL,
+    [EVLOG_NAME] = NULL,
+    [EVLOG_ENGAGE] = "%n engages target!",
+    [EVLOG_ALREADY_ENGAGED] = "%n is already engaged!",
+    [EVLOG_DISENGAGE] = "%n disengages.",
+    [EVLOG_MISS] = "%n misses %n.",
+    [EVLOG_HIT] = "%n hits %n for %d dmg. TP: %d",
+    [EVLOG_CRIT] = "%n crits %n for %d dmg. TP: %d",
+    [EVLOG_DEFEAT] = "%n defeats %n!",
+    [EVLOG_LEVEL_UP] = "%n is now Level %d %n!",
+    [EVLOG_STATUS_WEAR] = "%n's %n effect wears off.",
+    [EVLOG_POISON] = "%n takes %d poison damage.",
+    [EVLOG_BURROW] = "%n tunnels underground.",
+    [EVLOG_SURFACE] = "%n appears from underground.",
+    [EVLOG_AGGRO] = "%n notices %n!",
+    [EVLOG_STATUS_GAIN] = "%n gains the effect of %n.",
+    [EVLOG_TEXT_MORE] = NULL,
+    [EVLOG_WAIT] = "You wait.",
+    [EVLOG_BLOCKED] = "Blocked.",
+    [EVLOG_TARGET] = "Target: %n",
+    [EVLOG_NO_TARGET] = "No enemies in sight.",
+    [EVLOG_STATUS_DEFEAT] = "%n succumbs to %n.",
+};
+
+size_t evlog_format(const EvlogRecord* rec, char* buf, size_t size) {
+    if (size == 0) return 0;
+    buf[0] = '\0';
+
+    if (rec->code == EVLOG_TEXT || rec->code == EVLOG_NAME) {
+        snprintf(buf, size, "%.*s", EVLOG_TEXT_LEN, rec->text);
+        return strlen(buf);
+    }
+    if (rec->code == EVLOG_TEXT_MORE) {
+        snprintf(buf, size, "  %.*s", EVLOG_TEXT_LEN, rec->text); // Indented under its head
+        return strlen(buf);
+    }
+    if (rec->code >= EVLOG_CODE_MAX || !FORMATS[rec->code]) {
+        return (size_t)snprintf(buf, size, "<code %d>", rec->code);
+    }
+
+    size_t len = 0;
+    int arg = 0;
+    for (const char* f = FORMATS[rec->code]; *f && len + 1 < size; f++) {
+        if (f[0] == '%' && (f[1] == 'n' || f[1] == 'd') && arg < EVLOG_MAX_ARGS) {
+            int n;
+            if (f[1] == 'n') n = snprintf(buf + len, size - len, "%s", evlog_name(rec->args[arg++]));
+            else n = snprintf(buf + len, size - len, "%d", rec->args[arg++]);
+            len += (size_t)n;
+            if (len >= size) len = size - 1;
+            f++;
+        } else {
+            buf[len++] = *f;
+        }
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+// ----------------------------------------------------------------------------
+// Sink
+// ----------------------------------------------------------------------------
+
+static void flush_names(void) {
+    int count = __atomic_load_n(&name_count, __ATOMIC_ACQUIRE);
+    for (; names_flushed < count; names_flushed++) {
+        EvlogRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.code = EVLOG_NAME;
+        rec.aux = (uint16_t)names_flushed;
+        strncpy(rec.text, names[names_flushed], EVLOG_TEXT_LEN - 1);
+        fwrite(&rec, sizeof(rec), 1, sink);
+    }
+}
+
+void evlog_flush(void) {
+    if (!sink) return;
+
+    uint64_t head = evlog_head();
+    if (head - flushed_pos > EVLOG_CAPACITY) {
+        dropped += (long)(head - flushed_pos - EVLOG_CAPACITY);
+        flushed_pos = head - EVLOG_CAPACITY;
+    }
+
+    // Names first: every id a record uses was interned before it was published
+    flush_names();
+
+    EvlogRecord rec;
+    while (flushed_pos < head) {
+        if (!evlog_read(flushed_pos, &rec)) {
+            if (head - flushed_pos >= EVLOG_CAPACITY) {
+                dropped++; // Lapped while we looked
+                flushed_pos++;
+                continue;
+            }
+            break; // Still being written; pick it up next flush
+        }
+        fwrite(&rec, sizeof(rec), 1, sink);
+        flushed_pos++;
+    }
+    fflush(sink);
+}
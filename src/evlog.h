@@ -0,0 +1,103 @@
+#ifndef EVLOG_H
+#define EVLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "entity.h"
+
+// Binary Event Log
+// Game messages are appended as fixed-size records (code + args + tick) to a
+// lock-free ring. Nothing is formatted on the simulation path: the log window
+// formats the records it shows, and the on-disk sink is decoded offline
+// (tools/evlog_decode.c).
+
+typedef enum {
+    EVLOG_TEXT,             // Preformatted text (ui_log)
+    EVLOG_NAME,             // Sink only: defines a name id
+    EVLOG_ENGAGE,           // name
+    EVLOG_ALREADY_ENGAGED,  // name
+    EVLOG_DISENGAGE,        // name
+    EVLOG_MISS,             // attacker, target, attacker id, target id
+    EVLOG_HIT,              // attacker, target, damage, tp, tp gained, attacker id, target id
+    EVLOG_CRIT,             // attacker, target, damage, tp, tp gained, attacker id, target id
+    EVLOG_DEFEAT,           // attacker, target, attacker id, target id
+    EVLOG_LEVEL_UP,         // name, level, job name
+    EVLOG_STATUS_WEAR,      // name, status name
+    EVLOG_POISON,           // name, damage
+    EVLOG_BURROW,           // name
+    EVLOG_SURFACE,          // name
+    EVLOG_AGGRO,            // monster, target
+    EVLOG_STATUS_GAIN,      // name, status name
+    EVLOG_TEXT_MORE,        // Continues the EVLOG_TEXT record before it
+    EVLOG_WAIT,             // (none)
+    EVLOG_BLOCKED,          // (none)
+    EVLOG_TARGET,           // target
+    EVLOG_NO_TARGET,        // (none)
+    EVLOG_STATUS_DEFEAT,    // name, status name, id
+    EVLOG_CODE_MAX
+} EvlogCode;
+
+#define EVLOG_MAX_ARGS 12
+#define EVLOG_TEXT_LEN 48
+#define EVLOG_TEXT_MAX_RECORDS 4 // Text longer than one record wraps into EVLOG_TEXT_MORE
+#define EVLOG_TEXT_MAX ((EVLOG_TEXT_LEN - 1) * EVLOG_TEXT_MAX_RECORDS) // Longest text kept
+
+// One cache line per record
+typedef struct {
+    uint32_t seq;           // Write index + 1 once published, 0 while being written
+    uint16_t code;          // EvlogCode
+    uint16_t aux;           // EVLOG_NAME: the name id
+    int64_t tick;           // Game time of the event
+    union {
+        int32_t args[EVLOG_MAX_ARGS];
+        char text[EVLOG_TEXT_LEN];
+    };
+} EvlogRecord;
+
+// Args past the ones a message prints carry data for analytics (see parse.c).
+
+// Ring size (power of two). Also the log window's history.
+#define EVLOG_CAPACITY 1024
+
+// On-disk sink: header followed by raw records
+#define EVLOG_MAGIC "GFEVLOG"
+#define EVLOG_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+} EvlogFileHeader;
+
+// Opens the sink (NULL for memory only) and enables logging.
+// Logging is disabled until then, so headless tools pay nothing.
+void evlog_init(const char* sink_path);
+void evlog_shutdown(void);
+void evlog_set_enabled(bool enabled);
+
+// Writers (any thread)
+void evlog_emit(EvlogCode code, int argc, const int32_t* args);
+void evlog_text(const char* text); // Wrapped at spaces into adjacent records
+void evlog_1(EvlogCode code, int32_t a);
+void evlog_2(EvlogCode code, int32_t a, int32_t b);
+void evlog_3(EvlogCode code, int32_t a, int32_t b, int32_t c);
+void evlog_4(EvlogCode code, int32_t a, int32_t b, int32_t c, int32_t d);
+
+// Names
+// Records refer to strings by id. Ids are stable for the whole run.
+#define EVLOG_MAX_NAMES 512
+int evlog_intern(const char* name);
+const char* evlog_name(int id); // "?" for unknown ids
+int evlog_entity_name(Entity* e); // Interns e->name once and caches it in e->name_id
+void evlog_define_name(int id, const char* name); // Decoder: load a name from a sink
+
+// Readers
+uint64_t evlog_head(void); // Index one past the newest record
+bool evlog_read(uint64_t idx, EvlogRecord* out); // False if unpublished or overwritten
+size_t evlog_format(const EvlogRecord* rec, char* buf, size_t size);
+
+// Appends newly published records to the sink (main thread)
+void evlog_flush(void);
+
+#endif
@@ -7,7 +7,19 @@
 #include "map.h"
 #include "entity.h"
 #include "input.h"
+#include "command.h"
+#include "target.h"
+#include "sim.h"
+#include "save.h"
 #include "ai.h"
+#include "data.h"
+#include "combat.h"
+#include "evlog.h"
+#include "parse.h"
+#include "spatial.h"
+#include "region.h"
+#include "rng.h"
+#include "stimulus.h"
 
 Game g_game;
 
@@ -17,6 +29,17 @@ void game_init(void) {
     g_game.current_state = STATE_START_MENU;
     g_game.render_mode = RENDER_MODE_NORMAL;
     
+    // Event log first so load messages reach the log window
+    evlog_init("grindfest.evlog");
+    parse_reset();
+    
+    // Templates (before ncurses so load errors reach the terminal)
+    data_init_loaders();
+    data_load_jobs("data/jobs.txt");
+    data_load_monsters("data/monsters.txt");
+    ai_compile_behaviours();
+    command_init();
+    
     // Init modules
     ui_init(); // Needs layout
     ui_set_layout(UI_LAYOUT_GAME); // Default, but title screen might use another?
@@ -42,7 +65,8 @@ void game_init(void) {
     g_game.player.base_stats.str = 10;
     g_game.player.base_stats.dex = 10;
     g_game.player.base_stats.vit = 10;
-    g_game.player.current_stats = g_game.player.base_stats;
+    g_game.player.base_hp = 100;
+    entity_mark_dirty(&g_game.player);
     
     // Map generation happens later (in Nation Select or Game Start)
 
@@ -50,8 +74,8 @@ void game_init(void) {
     // Place Player on random floor
     int placed = 0;
     while(!placed) {
-        int rx = rand() % g_game.current_map.width;
-        int ry = rand() % g_game.current_map.height;
+        int rx = rng_range(0, g_game.current_map.width - 1);
+        int ry = rng_range(0, g_game.current_map.height - 1);
         if (map_is_walkable(&g_game.current_map, rx, ry) && !map_is_occupied(&g_game.current_map, rx, ry)) {
             g_game.player.x = rx;
             g_game.player.y = ry;
@@ -68,11 +92,22 @@ void game_init(void) {
 
 void game_cleanup(void) {
     ui_cleanup();
+    
+    parse_update();
+    if (!parse_export_csv("grindfest_parse.csv")) {
+        fprintf(stderr, "Could not write grindfest_parse.csv\n");
+    }
+    evlog_shutdown();
 }
 
 Entity* game_get_entity(EntityID id) {
     if (id == 0) return &g_game.player;
-    // Simple linear search for scaffold
+    // Spawned mobs are indexed by id
+    int idx = id - ENTITY_ID_BASE;
+    if (idx >= 0 && idx < g_game.entity_count && g_game.entities[idx].id == id) {
+        return &g_game.entities[idx];
+    }
+    // Fallback: linear search
     for (int i=0; i < g_game.entity_count; i++) {
         if (g_game.entities[i].id == id) return &g_game.entities[i];
     }
@@ -156,6 +191,7 @@ static void update_char_creator(void) {
         
         if (strlen(name_buf) > 0) {
             strncpy(g_game.player.name, name_buf, 31);
+            g_game.player.name_id = 0; // Re-intern under the new name
         } // else keep default "Adventurer"
         
         creator_step = CREATOR_STEP_RACE;
@@ -284,43 +320,30 @@ static void update_char_creator(void) {
 // ----------------------------------------------------------------------------
 
 void game_spawn_mobs(void) {
+    int tmpl_count = data_monster_count();
+    if (tmpl_count <= 0) {
+        ui_log("Error: No monster templates");
+        return;
+    }
+
+    int player_component = region_component_at(&g_game.current_map, g_game.player.x, g_game.player.y);
+
     // 10 Random mobs
     for (int i=0; i<10; i++) {
         if (g_game.entity_count >= MAX_ENTITIES) break;
         
-        Entity* e = &g_game.entities[g_game.entity_count]; // 0 is player, but entity_count tracks array usage. 
-        // Wait, g_game.entities[MAX_ENTITIES]... usually player is separate so entities array is just mobs?
-        // Let's check struct.
-        // Game { Entity player; Entity entities[MAX_ENTITIES]; int entity_count; }
-        // So entity_count refers to how many are in the entities array.
-        
-        // Simple Rabbit Template
-        e->id = g_game.entity_count + 100; // Offset ID
-        e->type = ENTITY_ENEMY;
-        e->is_active = true;
-        e->symbol = 'r';
-        e->color_pair = 3; // Red
-        strcpy(e->name, "Rabbit");
+        // Place where the player can reach
+        int x, y;
+        if (!region_random_free_tile(&g_game.current_map, player_component, &x, &y)) break; // Full
         
-        // Stats
-        e->base_stats.str = 5;
-        e->base_stats.vit = 4;
-        e->resources.max_hp = 30;
-        e->resources.hp = 30;
-        e->move_speed = 100;
-        e->is_aggressive = false;
-        
-        // Place
-        while(1) {
-            int x = rand() % g_game.current_map.width;
-            int y = rand() % g_game.current_map.height;
-            if (map_is_walkable(&g_game.current_map, x, y) && !map_is_occupied(&g_game.current_map, x, y)) {
-                e->x = x;
-                e->y = y;
-                map_set_occupied(&g_game.current_map, x, y, true);
-                break;
-            }
-        }
+        // Any compiled template may turn up; the mix follows data/monsters.txt
+        int tmpl = rng_range(0, tmpl_count - 1);
+
+        // Player is separate, so entity_count indexes the mob array directly
+        Entity* e = &g_game.entities[g_game.entity_count];
+        data_spawn_monster(tmpl, e, g_game.entity_count + ENTITY_ID_BASE, x, y);
+        map_set_occupied(&g_game.current_map, x, y, true);
+        spatial_insert(e);
         
         turn_add_event(turn_get_current_time() + 100, e->id, EVENT_MOVE);
         g_game.entity_count++;
@@ -329,12 +352,18 @@ void game_spawn_mobs(void) {
 
 void game_transition_zone(const char* target_map, int tx, int ty) {
     ui_log("Zoning...");
-    ui_render_log();
-    ui_refresh();
     
     // 1. Clear State
+    entity_flush_dirty_stats(); // Drop queued pointers into the old entity list
+    g_game.player.hated_by_count = 0; // Old mobs are gone with their hate lists
+    g_game.player.is_engaged = false;
+    target_clear();
     g_game.entity_count = 0; // Remove all mobs
+    ai_lod_reset();
+    spatial_reset();
     turn_clear();
+    parse_zone_reset();
+    entity_requeue_status(&g_game.player); // Effects carry over; their timers went with the queue
     
     // 2. Load Map
     if (strcmp(target_map, "PROCEDURAL") == 0) {
@@ -343,21 +372,18 @@ void game_transition_zone(const char* target_map, int tx, int ty) {
         
         // Valid Spawn for player if tx=-1
         if (tx == -1) {
-             while(1) {
-                int x = rand() % g_game.current_map.width;
-                int y = rand() % g_game.current_map.height;
-                if (map_is_walkable(&g_game.current_map, x, y)) {
-                    g_game.player.x = x;
-                    g_game.player.y = y;
-                    break;
-                }
-            }
+            // The drunken walk starts in the middle, which is always floor
+            g_game.player.x = g_game.current_map.width / 2;
+            g_game.player.y = g_game.current_map.height / 2;
+            region_random_free_tile(&g_game.current_map, region_largest_component(&g_game.current_map),
+                                    &g_game.player.x, &g_game.player.y);
         } else {
             g_game.player.x = tx;
             g_game.player.y = ty;
         }
         
-        // Spawn Mobs
+        // Spawn Mobs (around the player, not on them)
+        map_set_occupied(&g_game.current_map, g_game.player.x, g_game.player.y, true);
         game_spawn_mobs();
         
     } else {
@@ -379,9 +405,96 @@ void game_transition_zone(const char* target_map, int tx, int ty) {
     
     // 5. Restart Loop
     turn_add_event(turn_get_current_time(), g_game.player.id, EVENT_MOVE);
-    
-    // Force full refresh
-    ui_clear();
+}
+
+// ----------------------------------------------------------------------------
+// Save Games
+// ----------------------------------------------------------------------------
+
+static unsigned load_count = 0; // Lets a turn in progress see it was replaced
+
+bool game_save(const char* path) {
+    entity_flush_dirty_stats(); // Save settled stats, not a half-done batch
+
+    SaveResult res;
+    if (!save_write(&g_game, path, &res)) {
+        ui_log("Save failed: %s", res.error);
+        return false;
+    }
+    ui_log("Saved %s (%zu KB, %.1f ms).", path, (res.bytes + 1023) / 1024, res.ms);
+    return true;
+}
+
+bool game_load(const char* path) {
+    SaveResult res;
+    if (!save_read(&g_game, path, &res)) {
+        ui_log("Load failed: %s", res.error);
+        return false;
+    }
+    load_count++;
+
+    // The save was taken on the player's turn: that turn comes up first
+    turn_add_event(turn_get_current_time(), g_game.player.id, EVENT_MOVE);
+    sim_clock_restart();
+    g_game.current_state = STATE_DUNGEON_LOOP;
+    ui_log("Loaded %s (%.1f ms).", path, res.ms);
+    return true;
+}
+
+// Run-ahead
+// A held direction key queues many presses. While keys are queued, moves are
+// simulated back to back and only the last is drawn. A run stops, dropping
+// the rest of the queue, when the player has lost HP or a monster is in view
+// that was not in the last frame drawn.
+static int frame_hp = 0;
+static bool frame_saw[MAX_ENTITIES];
+
+static int monsters_in_view(Entity** out, int max) {
+    Entity* near[MAX_ENTITIES];
+    int n = spatial_query(g_game.player.x, g_game.player.y, FOV_RADIUS, near, MAX_ENTITIES);
+    int count = 0;
+    for (int i = 0; i < n && count < max; i++) {
+        Entity* m = near[i];
+        if (!m->is_active || m->is_burrowed) continue;
+        if (!g_game.current_map.tiles[m->x][m->y].visible) continue;
+        out[count++] = m;
+    }
+    return count;
+}
+
+static void remember_frame(void) {
+    Entity* seen[MAX_ENTITIES];
+    int n = monsters_in_view(seen, MAX_ENTITIES);
+    memset(frame_saw, 0, sizeof(frame_saw));
+    for (int i = 0; i < n; i++) frame_saw[seen[i] - g_game.entities] = true;
+    frame_hp = g_game.player.resources.hp;
+}
+
+static bool run_interrupted(void) {
+    if (g_game.player.resources.hp < frame_hp) return true;
+
+    Entity* seen[MAX_ENTITIES];
+    int n = monsters_in_view(seen, MAX_ENTITIES);
+    for (int i = 0; i < n; i++) {
+        if (!frame_saw[seen[i] - g_game.entities]) return true;
+    }
+    return false;
+}
+
+// Real-time mode: the player's turn came up with no command queued. Their
+// move event is held back until one arrives.
+static bool player_parked = false;
+
+// After combat_defeat: the corpse leaves the map. True if it was the player.
+static bool clear_defeated(Entity* target) {
+    // Free the tile so the corpse doesn't block movement
+    map_set_occupied(&g_game.current_map, target->x, target->y, false);
+    if (target != &g_game.player) {
+        spatial_remove(target);
+        return false;
+    }
+    g_game.current_state = STATE_GAME_OVER;
+    return true;
 }
 
 static void update_dungeon(void) {
@@ -394,158 +507,113 @@ static void update_dungeon(void) {
     Entity* e = game_get_entity(evt.entity_id);
     if (!e) return; // Entity might have died/vanished
     
-    if (evt.type == EVENT_MOVE) {
-         // Tick Status Effects whenever a move turn comes up
-         entity_tick_status(e);
-    }
+    if (evt.type == EVENT_STATUS_EXPIRE) {
+        entity_expire_status(e, (StatusEffectType)evt.data);
+    } else if (evt.type == EVENT_STATUS_TICK) {
+        if (entity_pulse_status(e, (StatusEffectType)evt.data)) {
+            combat_defeat(e);
+            if (clear_defeated(e)) return;
+        }
+    } else if (evt.type == EVENT_ATTACK_READY) {
+        // Bring every dirty entity up to date before combat resolves
+        entity_flush_dirty_stats();
 
-    if (evt.type == EVENT_ATTACK_READY) {
         // Process Auto Attack
         // Note: If Player Move and Attack happen at same time, Priority ID (insertion order)
         // determines order. Scheduler executes earlier enqueued event first.
-        if (e->is_engaged) {
-            ui_log("%s auto-attacks!", e->name);
-            // Schedule next attack
-            turn_add_event(evt.time + e->weapon_delay, e->id, EVENT_ATTACK_READY);
-
+        AttackResult res = combat_handle_attack_ready(e, evt.time);
+        if (res.target_id >= 0) {
+            ai_wake(game_get_entity(res.target_id));
+            ai_wake_at(&g_game, e->x, e->y, AI_WAKE_RADIUS_COMBAT); // Fights are noisy
+            stimulus_emit(&g_game, STIM_COMBAT, e->x, e->y, 100, e->id);
         }
+        if (res.defeated && clear_defeated(game_get_entity(res.target_id))) return;
     } else if (evt.type == EVENT_MOVE) {
         if (e->id == g_game.player.id) {
-            // Player Turn: Input Loop
-            // The game waits indefinitely for player input here.
-            // Render loop runs to keep UI fresh, but game time (simulation) is paused.
+            // Monsters near the player come out of hibernation
+            ai_lod_update(&g_game);
+            
+            // Player Turn: Command Loop
+            // The simulation thread waits here for the next command from the
+            // main thread, which keeps drawing and reading keys meanwhile.
             
             // Turn Logic (turn-cost units, not real-time):
             // 1. Pop the next event by scheduled time.
-            // 2. If it is the player's Move event, block for input.
-            // 3. Input determines action cost and schedules the next Move event.
+            // 2. If it is the player's Move event, block for a command.
+            // 3. The command determines action cost and schedules the next Move event.
             // 4. Any intermediate events (like auto-attacks) scheduled between now and the
             //    next Move event will be popped and processed in order before input resumes.
             
+            // FOV every turn, drawn or not: exploration and the run-ahead
+            // check depend on it
+            map_compute_fov(&g_game.current_map, g_game.player.x, g_game.player.y, FOV_RADIUS);
+
+            if (sim_pending() > 0 && run_interrupted()) {
+                sim_drop_commands(); // Stop where the player can see why
+            }
+
             // Loop until valid action taken
             bool turn_taken = false;
+            unsigned loads = load_count;
             while (!turn_taken) {
-                // Update FOV
-                map_compute_fov(&g_game.current_map, g_game.player.x, g_game.player.y, FOV_RADIUS);
-
-                // Update visuals (FOV, Render).
-                // Note: Simulation state (Smell/Sound) is NOT updated here.
-                // It only updates when 'turn_taken' becomes true.
-                
-                // Render
-                ui_clear();
-                ui_render_map(&g_game.current_map, &g_game.player, g_game.entities, g_game.entity_count, g_game.render_mode);
-                ui_render_stats(&g_game.player);
-                ui_render_log();
-                ui_render_input_line(""); // Clear input line
-                ui_refresh();
-                
-                char buf[256] = {0};
-                int key = ui_get_input(buf, 256, 150); // 150ms timeout
-                
-                InputResult res = input_handle_key(key);
-                
-                if (res.type == INPUT_ACTION_TIMEOUT) {
-                    ui_tick_animation();
-                    // Just continue, the loop will re-render
-                    continue;
+                if (sim_pending() == 0) {
+                    // Nothing queued: show this turn
+                    // Note: Simulation state (Smell/Sound) is NOT updated here.
+                    // It only updates when 'turn_taken' becomes true.
+                    parse_update();
+                    remember_frame();
+                    if (sim_realtime()) {
+                        // The clock doesn't wait: the next command gets the
+                        // tick it arrives on (simulate_realtime)
+                        player_parked = true;
+                        return;
+                    }
+                    sim_publish(&g_game, true);
                 }
+
+                SimCommand cmd;
+                sim_wait_command(&cmd);
                 
                 int dx = 0, dy = 0;
-                if (res.type == INPUT_ACTION_CANCEL) {
+                if (cmd.type == SIM_CMD_QUIT) {
                     // Quit request? For now, yes.
                     // Ideally: Confirmation prompt
                     g_game.running = false;
                     turn_taken = true;
                 }
-                else if (res.type == INPUT_ACTION_MENU) {
-                    ui_open_menu();
+                else if (cmd.type == SIM_CMD_MENU) {
+                    // Leave without ticking time: reschedule the current event
+                    // so it is handled again when the dungeon resumes.
                     g_game.current_state = STATE_MENU;
-                    // Do not set turn_taken=true; we just switch state and loop again
-                    // The main loop will switch to update_menu_loop() immediately
-                    // But we are inside `update_dungeon` input loop.
-                    // We need to break this input loop to let `game_run` switch dispatch.
-                    
-                    // We can return from update_dungeon?
-                    // Or set turn_taken=true (but that implies a turn passed?)
-                    // Actually, if we set turn_taken=true, it will attempt to simulate the turn.
-                    
-                    // Hack: We need a way to exit `update_dungeon` without ticking time.
-                    // The loop condition is `while (!turn_taken)`.
-                    // If we set turn_taken=true, it proceeds to check movement/actions.
-                    
-                    // Better approach: Check state *inside* the loop or change loop condition.
-                    // Or simply `return` from `update_dungeon`.
-                    // Reschedule the current event so we don't handle it now,
-                    // but we will handle it immediately when we return to this state.
                     turn_add_event(evt.time, evt.entity_id, evt.type);
-
-                    return; 
+                    return;
                 }
-                else if (res.type == INPUT_ACTION_COMMAND) {
-                    // Handle command? 
-                    // ...
-                    // If user types "/menu" or presses 'm' (need to map 'm')
-                    // For now let's map 'm' in input.c too? Or just use a command.
-                    
-                    // Let's use specific key for menu if we had one.
-                    // For now, let's assume we map 'm' to a new action or just use '/' command.
-                    
-                    // Actually, let's map 'm' to INPUT_ACTION_MENU in a future step or just use a command
-                    // "status"
+                else if (cmd.type == SIM_CMD_MOVE) {
+                    dx = cmd.dx;
+                    dy = cmd.dy;
                 }
-                else if (res.type == INPUT_ACTION_MOVE_UP) dy = -1;
-                else if (res.type == INPUT_ACTION_MOVE_UP) dy = -1;
-                else if (res.type == INPUT_ACTION_MOVE_DOWN) dy = 1;
-                else if (res.type == INPUT_ACTION_MOVE_LEFT) dx = -1;
-                else if (res.type == INPUT_ACTION_MOVE_RIGHT) dx = 1;
-                else if (res.type == INPUT_ACTION_MOVE_UP_LEFT) { dx = -1; dy = -1; }
-                else if (res.type == INPUT_ACTION_MOVE_UP_RIGHT) { dx = 1; dy = -1; }
-                else if (res.type == INPUT_ACTION_MOVE_DOWN_LEFT) { dx = -1; dy = 1; }
-                else if (res.type == INPUT_ACTION_MOVE_DOWN_RIGHT) { dx = 1; dy = 1; }
-                else if (res.type == INPUT_ACTION_VIEW_NORMAL) g_game.render_mode = RENDER_MODE_NORMAL;
-                else if (res.type == INPUT_ACTION_VIEW_SMELL) g_game.render_mode = RENDER_MODE_SMELL;
-                else if (res.type == INPUT_ACTION_VIEW_SOUND) g_game.render_mode = RENDER_MODE_SOUND;
-                else if (res.type == INPUT_ACTION_WAIT) {
-                    ui_log("You wait.");
+                else if (cmd.type == SIM_CMD_TARGET) {
+                    Entity* t = game_get_entity(target_cycle(&g_game, &g_game.player, cmd.arg));
+                    if (t) evlog_1(EVLOG_TARGET, evlog_entity_name(t));
+                    else evlog_emit(EVLOG_NO_TARGET, 0, NULL);
+                }
+                else if (cmd.type == SIM_CMD_MACRO) {
+                    if (!command_run_macro(cmd.arg, &g_game.player)) {
+                        ui_log("No macro on F%d (see /macro).", cmd.arg);
+                    }
+                }
+                else if (cmd.type == SIM_CMD_WAIT) {
+                    evlog_emit(EVLOG_WAIT, 0, NULL);
                     turn_taken = true;
                     // Standard wait cost (100)
                     turn_add_event(evt.time + 100, e->id, EVENT_MOVE);
                 }
-                else if (res.type == INPUT_ACTION_COMMAND) {
-                    // Enter command mode
-                    ui_render_input_line("/");
-                    ui_refresh();
-                    
-                    char cmd_buf[128];
-                    ui_get_string(NULL, cmd_buf, 128);
-                    
-                    // Prepend / to match expected format if user typed "attack" vs "/attack"?
-                    // ui_get_string captures what they typed.
-                    // prompt says "/attack".
-                    // Let's assume they type "attack" after the prompt /
-                    // Construct full string
-                    char full_cmd[130];
-                    sprintf(full_cmd, "/%s", cmd_buf);
-                    
-                    input_parse_command(full_cmd, &g_game.player, NULL);
-                    
-                    input_parse_command(full_cmd, &g_game.player, NULL);
-                    
-                    // Hack: Check if command switched state
-                    if (g_game.current_state == STATE_MENU) {
-                        turn_taken = true; // Break loop to enter menu loop next frame
-                        // But wait, if we return turn_taken=true, we might tick game clock?
-                        // We shouldn't tick clock for menu.
-                        // But update_dungeon expects turn_taken=true to actually process a turn.
-                        
-                        // We need to NOT increment time if we didn't actually take a turn.
-                        // But for now, let's just break the input loop.
-                    } else {
-                        turn_taken = false;
-                    }
+                else if (cmd.type == SIM_CMD_LINE) {
+                    command_execute(cmd.text, &g_game.player);
                 }
 
+                if (load_count != loads) return; // /load replaced this turn too
+
                 if (dx != 0 || dy != 0) {
                      int nx = e->x + dx;
                      int ny = e->y + dy;
@@ -560,10 +628,9 @@ static void update_dungeon(void) {
                              map_set_occupied(&g_game.current_map, e->x, e->y, true);
                              
                              turn_taken = true;
-                             // Smell update logic
-                             map_update_smell(&g_game.current_map, g_game.player.x, g_game.player.y);
-                             // Sound update logic (already handled by loop re-entry? no, instantaneous)
-                             map_update_sound(&g_game.current_map, g_game.player.x, g_game.player.y, 5);
+                             // Smell and sound layers (updated together on the task pool)
+                             map_update_senses(&g_game.current_map, g_game.player.x, g_game.player.y, 5);
+                             stimulus_emit(&g_game, STIM_FOOTSTEP, e->x, e->y, 100, e->id);
     
                              // Movement cost
                              // Use Entity stats later
@@ -611,7 +678,7 @@ static void update_dungeon(void) {
                              // Blocked by entity?
                              // Maybe attack?
                              // For now, simple block log
-                             ui_log("Blocked.");
+                             evlog_emit(EVLOG_BLOCKED, 0, NULL);
                          }
                      }
                 }
@@ -628,7 +695,167 @@ static void update_dungeon(void) {
     }
 }
 
+// Real-time: every event waits for its tick on the wall clock
+static void simulate_realtime(void) {
+    player_parked = false;
+    bool changed = true;
+    while (g_game.running && g_game.current_state == STATE_DUNGEON_LOOP) {
+        long next = turn_next_time();
+
+        // Show the world before sleeping, not between events on one tick
+        if (changed && (next < 0 || next > sim_clock_now())) {
+            sim_publish(&g_game, player_parked);
+            changed = false;
+        }
+
+        if (sim_clock_wait(next, player_parked) || !player_parked) {
+            update_dungeon();
+            changed = true;
+        } else {
+            // Queued into the next free slot: the tick the command came on
+            player_parked = false;
+            turn_add_event(sim_clock_now(), g_game.player.id, EVENT_MOVE);
+        }
+    }
+
+    // Left while parked (game over): give the player their event back
+    if (player_parked) {
+        player_parked = false;
+        turn_add_event(turn_get_current_time(), g_game.player.id, EVENT_MOVE);
+    }
+}
+
+// Simulation thread body: events until the dungeon is left
+static void simulate_dungeon(void) {
+    if (sim_realtime()) {
+        simulate_realtime();
+        return;
+    }
+    while (g_game.running && g_game.current_state == STATE_DUNGEON_LOOP) {
+        update_dungeon();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Dungeon Presentation
+// The main thread's half of the dungeon: it draws the newest snapshot and
+// turns keys into commands for the simulation thread.
+// ----------------------------------------------------------------------------
+
+static int frame_ms = 16; // Poll interval while the simulation is busy
+
+void game_set_frame_rate(int fps) {
+    frame_ms = fps > 0 ? 1000 / fps : 16;
+    if (frame_ms < 1) frame_ms = 1;
+}
+
+static void draw_snapshot(const WorldSnapshot* s) {
+    ui_clear();
+    ui_set_target(s->target);
+    ui_render_map(&s->view, &s->player, s->entities, s->entity_count, g_game.render_mode);
+    ui_render_stats(&s->player, s->time);
+    ui_render_minimap(&s->view, &s->player);
+    ui_render_log();
+    ui_render_input_line(""); // Clear input line
+    ui_refresh();
+}
+
+// Stages the command for a key; returns true if the screen needs a redraw
+static bool dispatch_input(const InputResult* res) {
+    SimCommand cmd = {0};
+
+    switch (res->type) {
+        case INPUT_ACTION_CANCEL: cmd.type = SIM_CMD_QUIT; break;
+        case INPUT_ACTION_MENU: cmd.type = SIM_CMD_MENU; break;
+        case INPUT_ACTION_WAIT: cmd.type = SIM_CMD_WAIT; break;
+        case INPUT_ACTION_MOVE_UP: cmd.type = SIM_CMD_MOVE; cmd.dy = -1; break;
+        case INPUT_ACTION_MOVE_DOWN: cmd.type = SIM_CMD_MOVE; cmd.dy = 1; break;
+        case INPUT_ACTION_MOVE_LEFT: cmd.type = SIM_CMD_MOVE; cmd.dx = -1; break;
+        case INPUT_ACTION_MOVE_RIGHT: cmd.type = SIM_CMD_MOVE; cmd.dx = 1; break;
+        case INPUT_ACTION_MOVE_UP_LEFT: cmd.type = SIM_CMD_MOVE; cmd.dx = -1; cmd.dy = -1; break;
+        case INPUT_ACTION_MOVE_UP_RIGHT: cmd.type = SIM_CMD_MOVE; cmd.dx = 1; cmd.dy = -1; break;
+        case INPUT_ACTION_MOVE_DOWN_LEFT: cmd.type = SIM_CMD_MOVE; cmd.dx = -1; cmd.dy = 1; break;
+        case INPUT_ACTION_MOVE_DOWN_RIGHT: cmd.type = SIM_CMD_MOVE; cmd.dx = 1; cmd.dy = 1; break;
+        case INPUT_ACTION_TARGET_NEXT: cmd.type = SIM_CMD_TARGET; cmd.arg = 1; break;
+        case INPUT_ACTION_TARGET_PREV: cmd.type = SIM_CMD_TARGET; cmd.arg = -1; break;
+        case INPUT_ACTION_MACRO: cmd.type = SIM_CMD_MACRO; cmd.arg = res->macro_slot; break;
+
+        // Views are drawn from the same snapshot; the simulation never knows
+        case INPUT_ACTION_VIEW_NORMAL: g_game.render_mode = RENDER_MODE_NORMAL; return true;
+        case INPUT_ACTION_VIEW_SMELL: g_game.render_mode = RENDER_MODE_SMELL; return true;
+        case INPUT_ACTION_VIEW_SOUND: g_game.render_mode = RENDER_MODE_SOUND; return true;
+
+        case INPUT_ACTION_COMMAND: {
+            sim_submit(); // Keys before the '/' run while the line is typed
+            ui_render_input_line("/");
+            ui_refresh();
+
+            char cmd_buf[COMMAND_LINE_LEN - 1];
+            ui_get_string(NULL, cmd_buf, sizeof(cmd_buf));
+            cmd.type = SIM_CMD_LINE;
+            snprintf(cmd.text, sizeof(cmd.text), "/%s", cmd_buf);
+            sim_queue(&cmd);
+            return true; // The prompt is still on screen
+        }
+        default:
+            return false;
+    }
+
+    if (!sim_queue(&cmd)) ui_log("Too many keys queued.");
+    return false;
+}
+
+static void run_dungeon(void) {
+    sim_start(simulate_dungeon);
+
+    uint64_t drawn = 0;
+    uint32_t drops_seen = 0;
+    uint32_t overviews_seen = 0;
+    while (sim_running()) {
+        const WorldSnapshot* s = sim_latest();
+        if (s && s->drops != drops_seen) {
+            ui_flush_input(); // Type-ahead goes with the interrupted run
+            drops_seen = s->drops;
+        }
+        if (s && s->overviews != overviews_seen) {
+            overviews_seen = s->overviews;
+            ui_render_overview(&s->view, &s->player);
+            ui_get_input(NULL, 0, -1); // Any key closes
+            drawn = 0;
+        }
+        if (s && s->seq != drawn) {
+            draw_snapshot(s);
+            evlog_flush(); // Persist while we wait on input
+            drawn = s->seq;
+        }
+
+        // Block on keys only while the simulation is blocked on us
+        int timeout = ui_animation_timeout();
+        if (!sim_idle(s) && (timeout < 0 || timeout > frame_ms)) timeout = frame_ms;
+        InputResult res = input_handle_key(ui_get_input(NULL, 0, timeout));
+        if (res.type == INPUT_ACTION_TIMEOUT) {
+            ui_animate(); // Only animated cells change
+            continue;
+        }
+
+        // Everything typed so far goes over as one batch
+        bool redraw = dispatch_input(&res);
+        while (ui_pending_keys() > 0) {
+            res = input_handle_key(ui_get_input(NULL, 0, 0));
+            redraw |= dispatch_input(&res);
+        }
+        sim_submit();
+        if (redraw) drawn = 0;
+    }
+    sim_join();
+    evlog_flush();
+
+    if (g_game.current_state == STATE_MENU) ui_open_menu();
+}
+
 static void update_menu_loop(void) {
+    entity_flush_dirty_stats(); // Status screen shows derived values
+
     // 1. Render Menu (Frozen Map Background state is preserved in map window buffer?)
     // Actually, ui_render_menu will handle the "Frozen" look.
     
@@ -650,14 +877,24 @@ static void update_menu_loop(void) {
     // Handle menu inputs...
 }
 
+static void update_game_over(void) {
+    ui_log("You have been defeated. Press any key.");
+    ui_render_log();
+    ui_refresh();
+    
+    char dummy[10];
+    ui_get_input(dummy, 10, -1); // blocking wait
+    g_game.running = false;
+}
+
 void game_run(void) {
     while (g_game.running) {
         switch (g_game.current_state) {
             case STATE_START_MENU: update_start_menu(); break;
             case STATE_CHAR_CREATOR: update_char_creator(); break;
-            case STATE_DUNGEON_LOOP: update_dungeon(); break;
+            case STATE_DUNGEON_LOOP: run_dungeon(); break;
             case STATE_MENU: update_menu_loop(); break;
-            case STATE_GAME_OVER: g_game.running = false; break;
+            case STATE_GAME_OVER: update_game_over(); break;
         }
     }
 }
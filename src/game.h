@@ -29,6 +29,7 @@ typedef struct {
     // We typically might have an array of entities for the level
     // For this scaffold, a simple array suffices
     #define MAX_ENTITIES 100
+    #define ENTITY_ID_BASE 100 // entities[i] has id ENTITY_ID_BASE + i
     Entity entities[MAX_ENTITIES];
     int entity_count;
     
@@ -36,10 +37,20 @@ typedef struct {
     // ... handled in UI module typically, but Game might push strings
 } Game;
 
+// A dropped back-reference would leave a stale hate entry behind (enmity.c)
+#if ENMITY_MAX_REFS < MAX_ENTITIES
+#error "ENMITY_MAX_REFS must cover every monster in a zone"
+#endif
+
 extern Game g_game;
 
 void game_init(void);
 void game_run(void);
+void game_set_frame_rate(int fps); // Dungeon redraw rate while the simulation is busy
+
+// Save games: on the player's turn (/save, /load), or before game_run
+bool game_save(const char* path);
+bool game_load(const char* path);
 void game_cleanup(void);
 
 // Helper to get entity by ID
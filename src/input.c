@@ -1,9 +1,5 @@
 #include <ncurses.h>
-#include <string.h>
 #include "input.h"
-#include "combat.h"
-#include "game.h"
-#include "ui.h"
 
 InputResult input_handle_key(int key) {
     InputResult res = {0};
@@ -41,11 +37,11 @@ InputResult input_handle_key(int key) {
         case 10: // \n
         case 13: // \r
         case KEY_ENTER:
-            return (InputResult){INPUT_ACTION_CONFIRM, ""};
+            return (InputResult){INPUT_ACTION_CONFIRM, "", 0};
             
         case 27: // ESC
-        case 'q': return (InputResult){INPUT_ACTION_CANCEL, ""};
-        case 'm': return (InputResult){INPUT_ACTION_MENU, ""};
+        case 'q': return (InputResult){INPUT_ACTION_CANCEL, "", 0};
+        case 'm': return (InputResult){INPUT_ACTION_MENU, "", 0};
             break;
         case '/':
             res.type = INPUT_ACTION_COMMAND;
@@ -62,6 +58,17 @@ InputResult input_handle_key(int key) {
         case KEY_F(3):
             res.type = INPUT_ACTION_VIEW_SOUND;
             break;
+        case KEY_F(5): case KEY_F(6): case KEY_F(7): case KEY_F(8):
+        case KEY_F(9): case KEY_F(10): case KEY_F(11): case KEY_F(12):
+            res.type = INPUT_ACTION_MACRO;
+            res.macro_slot = key - KEY_F(0);
+            break;
+        case '\t':
+            res.type = INPUT_ACTION_TARGET_NEXT;
+            break;
+        case KEY_BTAB:
+            res.type = INPUT_ACTION_TARGET_PREV;
+            break;
         case ERR:
             res.type = INPUT_ACTION_TIMEOUT;
             break;
@@ -70,39 +77,3 @@ InputResult input_handle_key(int key) {
     }
     return res;
 }
-
-void input_parse_command(const char* cmd_str, Entity* player, EntityID* target_out) {
-    char cmd[64];
-    char arg1[64];
-    (void)target_out; // Unused for now
-
-    int count = sscanf(cmd_str, "%s %s", cmd, arg1);
-    if (count < 1) return;
-    
-    if (strcmp(cmd, "/attack") == 0) {
-        // Find a target if not provided
-        EntityID tid = -1;
-        
-        // Very simple logic: If <t> is passed, use player->target_id
-        // If just /attack, pick closest.
-        
-        // Find first active entity that is NOT the player
-        for (int i=0; i<g_game.entity_count; i++) {
-            if (g_game.entities[i].id != player->id && g_game.entities[i].is_active) {
-                tid = g_game.entities[i].id;
-                break; // Found one
-            }
-        }
-        
-        if (tid != -1) {
-             combat_engage(player, tid);
-        } else {
-            ui_log("No valid target found.");
-        }
-        
-    } else if (strcmp(cmd, "/check") == 0) {
-        ui_log("Check command not impl.");
-    } else {
-        ui_log("Unknown command: %s", cmd);
-    }
-}
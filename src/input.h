@@ -22,17 +22,18 @@ typedef enum {
     INPUT_ACTION_VIEW_SOUND,
     INPUT_ACTION_WAIT,
     INPUT_ACTION_QUIT,
-    INPUT_ACTION_TIMEOUT
+    INPUT_ACTION_TIMEOUT,
+    INPUT_ACTION_MACRO,   // F5-F12
+    INPUT_ACTION_TARGET_NEXT, // Tab
+    INPUT_ACTION_TARGET_PREV  // Shift+Tab
 } InputAction;
 
 typedef struct {
     InputAction type;
     char command_buffer[256];
+    int macro_slot;       // INPUT_ACTION_MACRO: 5-12
 } InputResult;
 
 InputResult input_handle_key(int key);
 
-// Command Parser
-void input_parse_command(const char* cmd_str, Entity* player, EntityID* target_out);
-
 #endif
@@ -1,14 +1,49 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "game.h"
+#include "rng.h"
+#include "sim.h"
+#include "ai.h"
+#include "task.h"
+#include "ui.h"
 
-int main(void) {
-    srand(time(NULL));
+static void usage(void) {
+    fprintf(stderr, "Usage: grindfest [--ai-radius TILES] [--workers N] [--fps N] [--realtime TICKS_PER_SEC] [--load FILE] [--ansi]\n");
+}
+
+int main(int argc, char** argv) {
+    int workers = 0; // One per core
+    const char* load_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ai-radius") == 0 && i + 1 < argc) {
+            ai_lod_set_radius(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            game_set_frame_rate(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--realtime") == 0 && i + 1 < argc) {
+            sim_set_realtime(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            load_path = argv[++i];
+        } else if (strcmp(argv[i], "--ansi") == 0) {
+            ui_set_backend(UI_BACKEND_ANSI);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    rng_seed((uint64_t)time(NULL)); // The one stream gameplay draws from (saved with the game)
+    task_init(workers);
     
     game_init();
+    if (load_path) game_load(load_path); // On failure the title screen shows why
     game_run();
     game_cleanup();
+
+    task_shutdown();
     
     return 0;
 }
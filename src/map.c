@@ -3,7 +3,134 @@
 #include <math.h>
 #include <string.h>
 #include "map.h"
+#include "task.h"
+#include "region.h"
+#include "minimap.h"
+#include "rng.h"
 
+// ----------------------------------------------------------------------------
+// Grid Kernels
+// Full-map passes run over bands of columns on the task pool. Each pass only
+// writes its own band, reading neighbours from a previous pass (Jacobi style).
+// ----------------------------------------------------------------------------
+
+#define MAP_BAND_COLUMNS 16
+
+static uint8_t smell_next[MAX_MAP_WIDTH][MAX_MAP_HEIGHT];
+static bool wall_flip[MAX_MAP_WIDTH][MAX_MAP_HEIGHT];
+
+typedef struct {
+    Map* map;
+    int changes; // Cleanup: walls flipped this pass
+} MapJob;
+
+static void cleanup_mark_band(void* arg, int x0, int x1) {
+    MapJob* job = arg;
+    Map* map = job->map;
+    int changes = 0;
+    if (x0 < 1) x0 = 1;
+    if (x1 > map->width - 1) x1 = map->width - 1;
+
+    for (int x = x0; x < x1; x++) {
+        for (int y = 1; y < map->height - 1; y++) {
+            wall_flip[x][y] = false;
+            if (map->tiles[x][y].type != TILE_WALL) continue;
+
+            int neighbor_walls = 0;
+            if (map->tiles[x][y-1].type == TILE_WALL) neighbor_walls++;
+            if (map->tiles[x][y+1].type == TILE_WALL) neighbor_walls++;
+            if (map->tiles[x-1][y].type == TILE_WALL) neighbor_walls++;
+            if (map->tiles[x+1][y].type == TILE_WALL) neighbor_walls++;
+
+            if (neighbor_walls == 0) {
+                wall_flip[x][y] = true;
+                changes++;
+            }
+        }
+    }
+    if (changes) __atomic_add_fetch(&job->changes, changes, __ATOMIC_RELAXED);
+}
+
+static void cleanup_apply_band(void* arg, int x0, int x1) {
+    Map* map = ((MapJob*)arg)->map;
+    if (x0 < 1) x0 = 1;
+    if (x1 > map->width - 1) x1 = map->width - 1;
+
+    for (int x = x0; x < x1; x++) {
+        for (int y = 1; y < map->height - 1; y++) {
+            if (wall_flip[x][y]) map->tiles[x][y].type = TILE_FLOOR; // Flip isolated wall to floor
+        }
+    }
+}
+
+static void fov_reset_band(void* arg, int x0, int x1) {
+    Map* map = arg;
+    for (int x = x0; x < x1; x++) {
+        for (int y = 0; y < map->height; y++) {
+            map->tiles[x][y].visible = false;
+        }
+    }
+}
+
+static void sound_reset_band(void* arg, int x0, int x1) {
+    Map* map = arg;
+    for (int x = x0; x < x1; x++) {
+        for (int y = 0; y < map->height; y++) {
+            map->sound[x][y] = SOUND_NONE;
+        }
+    }
+}
+
+static void smell_decay_band(void* arg, int x0, int x1) {
+    Map* map = arg;
+    for (int x = x0; x < x1; x++) {
+        for (int y = 0; y < map->height; y++) {
+            if (map->smell[x][y] > 30) 
+                 map->smell[x][y] -= 30;
+            else 
+                 map->smell[x][y] = 0;
+        }
+    }
+}
+
+static void smell_diffuse_band(void* arg, int x0, int x1) {
+    Map* map = arg;
+    uint8_t drop_off = 80; // Diffusion loss
+
+    for (int x = x0; x < x1; x++) {
+        for (int y = 0; y < map->height; y++) {
+            smell_next[x][y] = map->smell[x][y];
+
+            if (x < 1 || y < 1 || x >= map->width - 1 || y >= map->height - 1) continue;
+            if (map->tiles[x][y].type == TILE_WALL || map->tiles[x][y].type == TILE_VOID)
+                continue; // Walls don't diffuse
+
+            // Check neighbors
+            uint8_t max_n = 0;
+            if (map->smell[x][y-1] > max_n) max_n = map->smell[x][y-1]; // N
+            if (map->smell[x][y+1] > max_n) max_n = map->smell[x][y+1]; // S
+            if (map->smell[x+1][y] > max_n) max_n = map->smell[x+1][y]; // E
+            if (map->smell[x-1][y] > max_n) max_n = map->smell[x-1][y]; // W
+
+            // Absorb
+            if (max_n > drop_off) {
+                uint8_t diffused = max_n - drop_off;
+                if (diffused > smell_next[x][y]) {
+                    smell_next[x][y] = diffused;
+                }
+            }
+        }
+    }
+}
+
+static void smell_apply_band(void* arg, int x0, int x1) {
+    Map* map = arg;
+    for (int x = x0; x < x1; x++) {
+        for (int y = 0; y < map->height; y++) {
+            map->smell[x][y] = smell_next[x][y];
+        }
+    }
+}
 
 void map_generate_dungeon(Map* map) {
     // Set Name
@@ -42,7 +169,7 @@ void map_generate_dungeon(Map* map) {
         }
 
         // Random direction
-        int dir = rand() % 4;
+        int dir = rng_range(0, 3);
         int dx = 0, dy = 0;
         switch(dir) {
             case 0: dy = -1; break; // Up
@@ -66,28 +193,31 @@ void map_generate_dungeon(Map* map) {
     }
 
     // 3. Post-Generation Cleanup (Remove Isolated Walls)
-    bool changes = true;
-    while(changes) {
-        changes = false;
-        for(int x=1; x<map->width-1; x++) {
-            for(int y=1; y<map->height-1; y++) {
-                if(map->tiles[x][y].type == TILE_WALL) {
-                    int neighbor_walls = 0;
-                    if(map->tiles[x][y-1].type == TILE_WALL) neighbor_walls++;
-                    if(map->tiles[x][y+1].type == TILE_WALL) neighbor_walls++;
-                    if(map->tiles[x-1][y].type == TILE_WALL) neighbor_walls++;
-                    if(map->tiles[x+1][y].type == TILE_WALL) neighbor_walls++;
-
-                    if(neighbor_walls == 0) {
-                        map->tiles[x][y].type = TILE_FLOOR; // Flip isolated wall to floor
-                        changes = true;
-                    }
-                }
+    MapJob job = {map, 1};
+    while (job.changes) {
+        job.changes = 0;
+        parallel_for(0, map->width, MAP_BAND_COLUMNS, cleanup_mark_band, &job);
+        if (job.changes) parallel_for(0, map->width, MAP_BAND_COLUMNS, cleanup_apply_band, &job);
+    }
+    
+    // 4. Connectivity Check
+    // The drunken walk is one path, but wall off anything the labelling finds
+    // outside the main component so every floor tile is reachable.
+    region_analyse(map);
+    if (map->regions.component_count > 1) {
+        int main_component = region_largest_component(map);
+        for (int x = 0; x < map->width; x++) {
+            for (int y = 0; y < map->height; y++) {
+                int c = region_component_at(map, x, y);
+                if (c >= 0 && c != main_component) map->tiles[x][y].type = TILE_WALL;
             }
         }
+        region_analyse(map);
     }
-    
-    // 4. Connectivity Check (Flood Fill) - Implicitly handled by Drunken Walk
+
+    map_index_free_tiles(map);
+    minimap_reset(map);
+    map->fov_boxed = false;
 }
 
 void main_cleanup(void); // Forward declaration to allow abort logic? Better to just exit(1) for fatal error
@@ -207,23 +337,49 @@ void map_load_static(Map* map, const char* filename) {
     }
     
     fclose(f);
+
+    region_analyse(map);
+    map_index_free_tiles(map);
+    minimap_reset(map);
+    map->fov_boxed = false;
 }
 
 // Field of View (Recursive Shadowcasting)
 
+// Lit this update; first sightings also go into the minimap
+static void fov_see(Map* map, int x, int y) {
+    Tile* t = &map->tiles[x][y];
+    t->visible = true;
+    if (!t->explored) {
+        t->explored = true;
+        minimap_mark(map, x, y);
+    }
+}
+
 // Raycasting fallback (Simple, robust)
 void map_compute_fov(Map* map, int px, int py, int radius) {
-    // 1. Reset visibility
-    for (int x = 0; x < map->width; x++) {
-        for (int y = 0; y < map->height; y++) {
-            map->tiles[x][y].visible = false;
+    // 1. Reset visibility: only the last FOV's square can be lit
+    if (map->fov_boxed) {
+        int x0 = map->fov_x - map->fov_radius, x1 = map->fov_x + map->fov_radius;
+        int y0 = map->fov_y - map->fov_radius, y1 = map->fov_y + map->fov_radius;
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 >= map->width) x1 = map->width - 1;
+        if (y1 >= map->height) y1 = map->height - 1;
+        for (int x = x0; x <= x1; x++) {
+            for (int y = y0; y <= y1; y++) map->tiles[x][y].visible = false;
         }
+    } else {
+        parallel_for(0, map->width, MAP_BAND_COLUMNS, fov_reset_band, map);
     }
+    map->fov_boxed = true;
+    map->fov_x = px;
+    map->fov_y = py;
+    map->fov_radius = radius;
     
     // 2. Mark player tile visible
     if (px >= 0 && px < map->width && py >= 0 && py < map->height) {
-        map->tiles[px][py].visible = true;
-        map->tiles[px][py].explored = true;
+        fov_see(map, px, py);
     }
 
     // 3. Cast rays to perimeter of square 2*radius
@@ -252,8 +408,7 @@ void map_compute_fov(Map* map, int px, int py, int radius) {
                 // Distance check
                 if ((tx-px)*(tx-px) + (ty-py)*(ty-py) > radius*radius) break;
 
-                map->tiles[tx][ty].visible = true;
-                map->tiles[tx][ty].explored = true;
+                fov_see(map, tx, ty);
                 
                 if (map->tiles[tx][ty].type == TILE_WALL) {
                     break; // Block sight
@@ -282,8 +437,7 @@ void map_compute_fov(Map* map, int px, int py, int radius) {
                 // Distance check
                 if ((tx-px)*(tx-px) + (ty-py)*(ty-py) > radius*radius) break;
 
-                map->tiles[tx][ty].visible = true;
-                map->tiles[tx][ty].explored = true;
+                fov_see(map, tx, ty);
                 
                 if (map->tiles[tx][ty].type == TILE_WALL) {
                     break; // Block sight
@@ -300,63 +454,18 @@ void map_compute_fov(Map* map, int px, int py, int radius) {
 
 void map_update_smell(Map* map, int px, int py) {
     // 1. Global Decay
-    for(int x=0; x<map->width; x++) {
-        for(int y=0; y<map->height; y++) {
-            if (map->smell[x][y] > 30) 
-                 map->smell[x][y] -= 30;
-            else 
-                 map->smell[x][y] = 0;
-        }
-    }
+    parallel_for(0, map->width, MAP_BAND_COLUMNS, smell_decay_band, map);
 
     // 2. Source (Player)
     if (px >= 0 && px < map->width && py >= 0 && py < map->height) {
         map->smell[px][py] = 255;
     }
 
-    // 3. Diffusion Pass (using temp buffer to avoid directional bias)
-    uint8_t next_smell[MAX_MAP_WIDTH][MAX_MAP_HEIGHT];
-    // Copy current state
-    for(int x=0; x<map->width; x++) {
-        for(int y=0; y<map->height; y++) {
-            next_smell[x][y] = map->smell[x][y];
-        }
-    }
-
-    uint8_t drop_off = 80; // Diffusion loss
-
-    for(int x=1; x<map->width-1; x++) {
-        for(int y=1; y<map->height-1; y++) {
-            if (map->tiles[x][y].type == TILE_WALL || map->tiles[x][y].type == TILE_VOID)
-                continue; // Walls don't diffuse
-
-            // Check neighbors
-            uint8_t max_n = 0;
-            // N
-            if (map->smell[x][y-1] > max_n) max_n = map->smell[x][y-1];
-            // S
-            if (map->smell[x][y+1] > max_n) max_n = map->smell[x][y+1];
-            // E
-            if (map->smell[x+1][y] > max_n) max_n = map->smell[x+1][y];
-            // W
-            if (map->smell[x-1][y] > max_n) max_n = map->smell[x-1][y];
-
-            // Absorb
-            if (max_n > drop_off) {
-                uint8_t diffused = max_n - drop_off;
-                if (diffused > next_smell[x][y]) {
-                    next_smell[x][y] = diffused;
-                }
-            }
-        }
-    }
+    // 3. Diffusion Pass (into a second buffer to avoid directional bias)
+    parallel_for(0, map->width, MAP_BAND_COLUMNS, smell_diffuse_band, map);
 
     // Apply back
-    for(int x=0; x<map->width; x++) {
-        for(int y=0; y<map->height; y++) {
-            map->smell[x][y] = next_smell[x][y];
-        }
-    }
+    parallel_for(0, map->width, MAP_BAND_COLUMNS, smell_apply_band, map);
 }
 
 // Simple BFS Queue for Sound
@@ -368,11 +477,7 @@ typedef struct {
 
 void map_update_sound(Map* map, int px, int py, int radius) {
     // 1. Reset
-    for(int x=0; x<map->width; x++) {
-        for(int y=0; y<map->height; y++) {
-            map->sound[x][y] = SOUND_NONE;
-        }
-    }
+    parallel_for(0, map->width, MAP_BAND_COLUMNS, sound_reset_band, map);
 
     if (px < 0 || px >= map->width || py < 0 || py >= map->height) return;
 
@@ -435,6 +540,34 @@ SoundState map_sound_at(const Map* map, int x, int y) {
      return map->sound[x][y];
 }
 
+// Smell and sound touch separate layers, so they update side by side
+typedef struct {
+    Map* map;
+    int px, py;
+    int sound_radius;
+} SenseJob;
+
+static void senses_smell_task(void* arg, int begin, int end) {
+    (void)begin; (void)end;
+    SenseJob* job = arg;
+    map_update_smell(job->map, job->px, job->py);
+}
+
+static void senses_sound_task(void* arg, int begin, int end) {
+    (void)begin; (void)end;
+    SenseJob* job = arg;
+    map_update_sound(job->map, job->px, job->py, job->sound_radius);
+}
+
+void map_update_senses(Map* map, int px, int py, int sound_radius) {
+    SenseJob job = {map, px, py, sound_radius};
+    TaskGraph graph;
+    task_graph_init(&graph);
+    task_graph_add(&graph, senses_smell_task, &job);
+    task_graph_add(&graph, senses_sound_task, &job);
+    task_graph_run(&graph);
+}
+
 bool map_is_walkable(Map* map, int x, int y) {
     if (x < 0 || x >= map->width || y < 0 || y >= map->height) return false;
     return (
@@ -450,12 +583,182 @@ bool map_is_walkable(Map* map, int x, int y) {
 // Occupancy
 // ----------------------------------------------------------------------------
 
+static void free_add(Map* map, int x, int y);
+static void free_remove(Map* map, int x, int y);
+
 void map_set_occupied(Map* map, int x, int y, bool occupied) {
     if (x < 0 || y < 0 || x >= map->width || y >= map->height) return;
     map->tiles[x][y].occupied = occupied;
+
+    if (occupied) free_remove(map, x, y);
+    else if (map_is_walkable(map, x, y)) free_add(map, x, y);
 }
 
 bool map_is_occupied(Map* map, int x, int y) {
     if (x < 0 || y < 0 || x >= map->width || y >= map->height) return true; // Treat OOB as occupied
     return map->tiles[x][y].occupied;
 }
+
+// ----------------------------------------------------------------------------
+// Free Tiles
+// ----------------------------------------------------------------------------
+
+static int free_sector(int x, int y) {
+    return (y >> MAP_FREE_SECTOR_SHIFT) * MAP_FREE_SECTORS_X + (x >> MAP_FREE_SECTOR_SHIFT);
+}
+
+static void free_add(Map* map, int x, int y) {
+    MapFreeSet* fs = &map->free;
+    if (fs->slot[x][y] >= 0) return;
+
+    fs->slot[x][y] = fs->count;
+    fs->tiles[fs->count++] = x | (y << 8);
+
+    int sec = free_sector(x, y);
+    fs->sector_slot[x][y] = (uint8_t)fs->sector_count[sec];
+    fs->sector_tiles[sec][fs->sector_count[sec]++] =
+        (uint8_t)((x & (MAP_FREE_SECTOR_SIZE - 1)) | ((y & (MAP_FREE_SECTOR_SIZE - 1)) << MAP_FREE_SECTOR_SHIFT));
+}
+
+// Swap-remove from both sets
+static void free_remove(Map* map, int x, int y) {
+    MapFreeSet* fs = &map->free;
+    int idx = fs->slot[x][y];
+    if (idx < 0) return;
+
+    int last = fs->tiles[--fs->count];
+    fs->tiles[idx] = last;
+    fs->slot[last & 0xFF][last >> 8] = idx;
+    fs->slot[x][y] = -1;
+
+    int sec = free_sector(x, y);
+    int sidx = fs->sector_slot[x][y];
+    uint8_t slast = fs->sector_tiles[sec][--fs->sector_count[sec]];
+    fs->sector_tiles[sec][sidx] = slast;
+    int bx = (x & ~(MAP_FREE_SECTOR_SIZE - 1)) + (slast & (MAP_FREE_SECTOR_SIZE - 1));
+    int by = (y & ~(MAP_FREE_SECTOR_SIZE - 1)) + (slast >> MAP_FREE_SECTOR_SHIFT);
+    fs->sector_slot[bx][by] = (uint8_t)sidx;
+}
+
+void map_index_free_tiles(Map* map) {
+    MapFreeSet* fs = &map->free;
+    fs->count = 0;
+    memset(fs->sector_count, 0, sizeof(fs->sector_count));
+    memset(fs->slot, 0xFF, sizeof(fs->slot)); // -1
+
+    for (int y = 0; y < map->height; y++) {
+        for (int x = 0; x < map->width; x++) {
+            if (map_is_walkable(map, x, y) && !map->tiles[x][y].occupied) free_add(map, x, y);
+        }
+    }
+}
+
+int map_free_tile_count(const Map* map) {
+    return map->free.count;
+}
+
+bool map_random_free_tile(const Map* map, int* x, int* y) {
+    if (map->free.count == 0) return false;
+    int t = map->free.tiles[rng_range(0, map->free.count - 1)];
+    *x = t & 0xFF;
+    *y = t >> 8;
+    return true;
+}
+
+// Visits the free tiles of the rect sector by sector. Sectors wholly inside
+// are counted in O(1); only those on the rect's edge are scanned.
+typedef struct {
+    int x0, y0, x1, y1;
+    int pick;   // Select mode: index of the tile to return, -1 = just count
+    int x, y;
+} FreeRectQuery;
+
+static int free_rect_walk(const Map* map, FreeRectQuery* q) {
+    const MapFreeSet* fs = &map->free;
+    int seen = 0;
+
+    for (int sy = q->y0 >> MAP_FREE_SECTOR_SHIFT; sy <= q->y1 >> MAP_FREE_SECTOR_SHIFT; sy++) {
+        for (int sx = q->x0 >> MAP_FREE_SECTOR_SHIFT; sx <= q->x1 >> MAP_FREE_SECTOR_SHIFT; sx++) {
+            int sec = sy * MAP_FREE_SECTORS_X + sx;
+            int n = fs->sector_count[sec];
+            if (n == 0) continue;
+
+            int bx = sx << MAP_FREE_SECTOR_SHIFT;
+            int by = sy << MAP_FREE_SECTOR_SHIFT;
+            bool inside = bx >= q->x0 && by >= q->y0 &&
+                          bx + MAP_FREE_SECTOR_SIZE - 1 <= q->x1 && by + MAP_FREE_SECTOR_SIZE - 1 <= q->y1;
+
+            if (inside) {
+                if (q->pick >= seen && q->pick < seen + n) {
+                    uint8_t t = fs->sector_tiles[sec][q->pick - seen];
+                    q->x = bx + (t & (MAP_FREE_SECTOR_SIZE - 1));
+                    q->y = by + (t >> MAP_FREE_SECTOR_SHIFT);
+                    return seen;
+                }
+                seen += n;
+                continue;
+            }
+
+            for (int i = 0; i < n; i++) {
+                uint8_t t = fs->sector_tiles[sec][i];
+                int tx = bx + (t & (MAP_FREE_SECTOR_SIZE - 1));
+                int ty = by + (t >> MAP_FREE_SECTOR_SHIFT);
+                if (tx < q->x0 || tx > q->x1 || ty < q->y0 || ty > q->y1) continue;
+                if (seen++ == q->pick) {
+                    q->x = tx;
+                    q->y = ty;
+                    return seen;
+                }
+            }
+        }
+    }
+    return seen;
+}
+
+bool map_random_free_tile_in_rect(const Map* map, int x0, int y0, int x1, int y1, int* x, int* y) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= map->width) x1 = map->width - 1;
+    if (y1 >= map->height) y1 = map->height - 1;
+    if (x0 > x1 || y0 > y1) return false;
+
+    FreeRectQuery q = {x0, y0, x1, y1, -1, 0, 0};
+    int total = free_rect_walk(map, &q);
+    if (total == 0) return false;
+
+    q.pick = rng_range(0, total - 1);
+    free_rect_walk(map, &q);
+    *x = q.x;
+    *y = q.y;
+    return true;
+}
+
+bool map_random_free_tile_near(const Map* map, int cx, int cy, int radius, int* x, int* y) {
+    return map_random_free_tile_in_rect(map, cx - radius, cy - radius, cx + radius, cy + radius, x, y);
+}
+
+// ----------------------------------------------------------------------------
+// Line of Sight
+// ----------------------------------------------------------------------------
+
+// Bresenham's line; walls between the two points block (the ends don't)
+bool map_line_of_sight(const Map* map, int x0, int y0, int x1, int y1) {
+    int sx0 = x0, sy0 = y0;
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    while (true) {
+        if (x0 == x1 && y0 == y1) return true;
+
+        if (x0 != sx0 || y0 != sy0) {
+            if (x0 < 0 || y0 < 0 || x0 >= map->width || y0 >= map->height) return false;
+            if (map->tiles[x0][y0].type == TILE_WALL) return false;
+        }
+
+        if (2 * err >= dy) { err += dy; x0 += sx; }
+        if (2 * err <= dx) { err += dx; y0 += sy; }
+    }
+}
@@ -48,6 +48,95 @@ typedef enum {
     SOUND_MUFFLED = 2
 } SoundState;
 
+// Free Tiles
+// Walkable, unoccupied tiles kept as dense sets (whole map and per 16x16
+// sector) so spawns and burrows can sample one uniformly in O(1).
+#define MAP_FREE_SECTOR_SHIFT 4
+#define MAP_FREE_SECTOR_SIZE (1 << MAP_FREE_SECTOR_SHIFT)
+#define MAP_FREE_SECTORS_X (MAX_MAP_WIDTH >> MAP_FREE_SECTOR_SHIFT)
+#define MAP_FREE_SECTORS_Y (MAX_MAP_HEIGHT >> MAP_FREE_SECTOR_SHIFT)
+
+typedef struct {
+    int tiles[MAX_MAP_WIDTH * MAX_MAP_HEIGHT];       // x | y << 8
+    int count;
+    int slot[MAX_MAP_WIDTH][MAX_MAP_HEIGHT];          // Index in tiles, -1 = not free
+    uint8_t sector_tiles[MAP_FREE_SECTORS_X * MAP_FREE_SECTORS_Y][MAP_FREE_SECTOR_SIZE * MAP_FREE_SECTOR_SIZE]; // Local x | y << 4
+    uint16_t sector_count[MAP_FREE_SECTORS_X * MAP_FREE_SECTORS_Y];
+    uint8_t sector_slot[MAX_MAP_WIDTH][MAX_MAP_HEIGHT]; // Index in its sector's tiles
+} MapFreeSet;
+
+// Regions
+// Walkable tiles split into rooms, corridors, bridges and doorways, grouped
+// into connected components and linked into a graph (see region.h).
+#define MAP_MAX_REGIONS 4096
+#define MAP_MAX_REGION_LINKS 16384
+#define REGION_NONE 0xFFFF
+
+typedef enum {
+    REGION_ROOM,
+    REGION_CORRIDOR, // One tile wide
+    REGION_BRIDGE,
+    REGION_DOOR
+} RegionKind;
+
+typedef enum {
+    REGION_LINK_OPEN,     // Regions touch
+    REGION_LINK_DOOR,
+    REGION_LINK_BRIDGE,
+    REGION_LINK_TELEPORT  // One way, from the teleport's region
+} RegionLinkKind;
+
+typedef struct {
+    RegionKind kind;
+    int component;
+    int tiles;
+    int x0, y0, x1, y1;   // Bounding box
+    int first_link;       // Into MapRegions.links
+    int link_count;
+} MapRegion;
+
+typedef struct {
+    uint16_t to;
+    uint8_t kind;         // RegionLinkKind
+} MapRegionLink;
+
+typedef struct {
+    uint16_t tile_region[MAX_MAP_WIDTH][MAX_MAP_HEIGHT]; // REGION_NONE = blocked
+    MapRegion regions[MAP_MAX_REGIONS];
+    int region_count;
+    MapRegionLink links[MAP_MAX_REGION_LINKS];
+    int link_count;
+    int component_tiles[MAP_MAX_REGIONS];
+    int component_count;
+} MapRegions;
+
+// Minimap
+// Pyramid over the explored layer: a level L cell covers 2^L x 2^L tiles and
+// records which of its four quadrants hold explored open ground, plus the
+// most notable kind of tile under it. Kept up to date as tiles are explored
+// (see minimap.h).
+#define MAP_MINIMAP_LEVELS 5 // 2x2 .. 32x32 tiles per cell
+#define MAP_MINIMAP_CELLS ((MAX_MAP_WIDTH / 2) * (MAX_MAP_HEIGHT / 2) * 4 / 3) // Geometric sum, rounded up
+
+typedef enum {
+    MINIMAP_NONE,   // Nothing explored, or only walls
+    MINIMAP_FLOOR,
+    MINIMAP_BRIDGE,
+    MINIMAP_WATER,
+    MINIMAP_EXIT,   // Zone lines, stairs, teleports
+    MINIMAP_KIND_COUNT
+} MinimapKind;
+
+typedef struct {
+    uint8_t mask; // Quadrants: 1 = NW, 2 = NE, 4 = SW, 8 = SE
+    uint8_t kind; // MinimapKind; higher wins
+} MapMinimapCell;
+
+typedef struct {
+    MapMinimapCell cells[MAP_MINIMAP_CELLS];
+    uint32_t version; // Bumped on every change, so copies know when they are stale
+} MapMinimap;
+
 typedef struct {
     char name[64];
     int width;
@@ -62,6 +151,15 @@ typedef struct {
     #define MAX_TELEPORTS 16
     MapTeleport teleports[MAX_TELEPORTS];
     int teleport_count;
+
+    MapFreeSet free;
+    MapRegions regions;
+    MapMinimap minimap;
+
+    // Square lit by the last map_compute_fov, so the next one only clears
+    // that box. fov_boxed is false until the first FOV (e.g. after a load).
+    bool fov_boxed;
+    int fov_x, fov_y, fov_radius;
 } Map;
 
 // Map Gen
@@ -73,6 +171,13 @@ bool map_is_walkable(Map* map, int x, int y);
 void map_set_occupied(Map* map, int x, int y, bool occupied);
 bool map_is_occupied(Map* map, int x, int y);
 
+// Free tile sampling (uniform). Return false when there is no free tile.
+void map_index_free_tiles(Map* map); // After the tiles change; generation and loading do this
+int map_free_tile_count(const Map* map);
+bool map_random_free_tile(const Map* map, int* x, int* y);
+bool map_random_free_tile_in_rect(const Map* map, int x0, int y0, int x1, int y1, int* x, int* y); // Inclusive
+bool map_random_free_tile_near(const Map* map, int cx, int cy, int radius, int* x, int* y);       // Chebyshev radius
+
 // FOV
 #define FOV_RADIUS 8
 void map_compute_fov(Map* map, int px, int py, int radius);
@@ -80,6 +185,10 @@ void map_compute_fov(Map* map, int px, int py, int radius);
 // Sensory
 void map_update_smell(Map* map, int px, int py);
 void map_update_sound(Map* map, int px, int py, int radius);
+void map_update_senses(Map* map, int px, int py, int sound_radius); // Both of the above, concurrently
+
+// Line of Sight
+bool map_line_of_sight(const Map* map, int x0, int y0, int x1, int y1);
 
 // Helpers
 bool map_is_smelly(const Map* map, int x, int y);
@@ -0,0 +1,76 @@
+#include <string.h>
+#include "minimap.h"
+
+// Levels are stored one after another, each a (MAX / 2^L)-wide grid
+static int level_offset(int level) {
+    int offset = 0;
+    for (int l = 1; l < level; l++) offset += (MAX_MAP_WIDTH >> l) * (MAX_MAP_HEIGHT >> l);
+    return offset;
+}
+
+static MapMinimapCell* cell_at(Map* map, int level, int cx, int cy) {
+    return &map->minimap.cells[level_offset(level) + cy * (MAX_MAP_WIDTH >> level) + cx];
+}
+
+static MinimapKind tile_kind(TileType type) {
+    switch (type) {
+        case TILE_FLOOR:
+        case TILE_DOOR:
+            return MINIMAP_FLOOR;
+        case TILE_BRIDGE:
+            return MINIMAP_BRIDGE;
+        case TILE_WATER:
+            return MINIMAP_WATER;
+        case TILE_ZONE:
+        case TILE_STAIRS_UP:
+        case TILE_STAIRS_DOWN:
+        case TILE_TELEPORT:
+            return MINIMAP_EXIT;
+        default:
+            return MINIMAP_NONE; // Walls and void stay empty
+    }
+}
+
+void minimap_reset(Map* map) {
+    uint32_t version = map->minimap.version;
+    memset(&map->minimap, 0, sizeof(MapMinimap));
+    map->minimap.version = version + 1; // Never back to a number a copy has seen
+}
+
+void minimap_mark(Map* map, int x, int y) {
+    MinimapKind kind = tile_kind(map->tiles[x][y].type);
+    if (kind == MINIMAP_NONE) return;
+    map->minimap.version++;
+
+    // Climb while something changes: a cell that gains its first quadrant
+    // sets a bit in its parent, and a new highest kind carries up as well.
+    for (int level = 1; level <= MAP_MINIMAP_LEVELS; level++) {
+        uint8_t bit = (uint8_t)(1 << ((x & 1) + 2 * (y & 1)));
+        x >>= 1;
+        y >>= 1;
+
+        MapMinimapCell* c = cell_at(map, level, x, y);
+        bool first = (c->mask == 0);
+        bool raised = (kind > c->kind);
+        c->mask |= bit;
+        if (raised) c->kind = (uint8_t)kind;
+        if (!first && !raised) return;
+    }
+}
+
+const MapMinimapCell* minimap_cell(const MapMinimap* minimap, int width, int height, int level, int cx, int cy) {
+    if (level < 1 || level > MAP_MINIMAP_LEVELS) return NULL;
+    int w = (width + (1 << level) - 1) >> level;
+    int h = (height + (1 << level) - 1) >> level;
+    if (cx < 0 || cy < 0 || cx >= w || cy >= h) return NULL;
+    return &minimap->cells[level_offset(level) + cy * (MAX_MAP_WIDTH >> level) + cx];
+}
+
+int minimap_fit_level(int width, int height, int cols, int rows) {
+    for (int level = 1; level < MAP_MINIMAP_LEVELS; level++) {
+        int w = (width + (1 << level) - 1) >> level;
+        int h = (height + (1 << level) - 1) >> level;
+        if (w <= cols && h <= rows) return level;
+    }
+    return MAP_MINIMAP_LEVELS;
+}
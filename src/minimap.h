@@ -0,0 +1,18 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "map.h"
+
+// Minimap Pyramid
+// Built from Map.minimap as the player explores: map_compute_fov marks each
+// newly explored tile, which touches one cell per level. Views read only the
+// cells they draw, so opening the overview never scans the map.
+
+void minimap_reset(Map* map);                 // After load/generation; nothing explored
+void minimap_mark(Map* map, int x, int y);    // Tile just became explored
+
+// Readers take the pyramid and map size, so a copy (MapView) works as well
+const MapMinimapCell* minimap_cell(const MapMinimap* minimap, int width, int height, int level, int cx, int cy); // NULL outside the map
+int minimap_fit_level(int width, int height, int cols, int rows); // Finest level (1..MAP_MINIMAP_LEVELS) that fits
+
+#endif
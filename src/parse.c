@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <string.h>
+#include "parse.h"
+#include "turn.h"
+#include "ui.h"
+
+#define MAX_PARSE_ACTORS 64
+#define MAX_PARSE_FIGHTS 64 // Targets swung at but not yet defeated
+
+typedef struct {
+    EntityID target_id;
+    long start_tick;
+} ParseFight;
+
+static ParseActor actors[MAX_PARSE_ACTORS];
+static int actor_count = 0;
+static int16_t actor_of_name[EVLOG_MAX_NAMES]; // name id -> actor index + 1
+
+static ParseFight fights[MAX_PARSE_FIGHTS];
+static int fight_count = 0;
+
+static ParseSession session;
+static uint64_t read_pos = 0;
+
+void parse_reset(void) {
+    memset(actors, 0, sizeof(actors));
+    memset(actor_of_name, 0, sizeof(actor_of_name));
+    actor_count = 0;
+    fight_count = 0;
+    memset(&session, 0, sizeof(session));
+    session.first_tick = -1;
+    read_pos = evlog_head(); // Only count what happens from now on
+}
+
+void parse_zone_reset(void) {
+    parse_update(); // Settle fights logged under the old ids first
+    fight_count = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Histograms & Windows
+// ----------------------------------------------------------------------------
+
+static int hist_bucket(int v) {
+    if (v < 32) return v < 0 ? 0 : v;
+    int e = 31 - __builtin_clz((unsigned int)v); // floor(log2 v), >= 5
+    int b = 32 + (e - 5) * 8 + ((v >> (e - 3)) & 7);
+    return b < PARSE_HIST_BUCKETS ? b : PARSE_HIST_BUCKETS - 1;
+}
+
+static int hist_lower_bound(int b) {
+    if (b < 32) return b;
+    int e = 5 + (b - 32) / 8;
+    int m = (b - 32) % 8;
+    return (8 + m) << (e - 3);
+}
+
+void parse_hist_add(ParseHistogram* h, int value) {
+    h->counts[hist_bucket(value)]++;
+    h->samples++;
+    if (value > h->max) h->max = value;
+}
+
+int parse_hist_percentile(const ParseHistogram* h, double p) {
+    if (h->samples == 0) return 0;
+    long want = (long)(h->samples * p);
+    long seen = 0;
+    for (int b = 0; b < PARSE_HIST_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen > want) return hist_lower_bound(b);
+    }
+    return h->max;
+}
+
+static void window_add(ParseWindow* w, long tick, int value) {
+    long sec = tick / TURN_TICKS_PER_SECOND;
+    int slot = (int)(sec % PARSE_WINDOW_SECONDS);
+    if (w->seconds[slot] != sec) {
+        w->seconds[slot] = sec;
+        w->sums[slot] = 0;
+    }
+    w->sums[slot] += value;
+}
+
+double parse_window_rate(const ParseWindow* w, long now) {
+    long sec = now / TURN_TICKS_PER_SECOND;
+    long total = 0;
+    for (int i = 0; i < PARSE_WINDOW_SECONDS; i++) {
+        if (w->seconds[i] > sec - PARSE_WINDOW_SECONDS && w->seconds[i] <= sec) total += w->sums[i];
+    }
+    return (double)total / PARSE_WINDOW_SECONDS;
+}
+
+// ----------------------------------------------------------------------------
+// Aggregation
+// ----------------------------------------------------------------------------
+
+static ParseActor* actor_for(int name_id, long tick) {
+    if (name_id <= 0 || name_id >= EVLOG_MAX_NAMES) return NULL;
+
+    int idx = actor_of_name[name_id] - 1;
+    if (idx < 0) {
+        if (actor_count >= MAX_PARSE_ACTORS) return NULL;
+        idx = actor_count++;
+        actor_of_name[name_id] = (int16_t)(idx + 1);
+
+        ParseActor* a = &actors[idx];
+        a->name_id = name_id;
+        a->first_tick = tick;
+        for (int i = 0; i < PARSE_WINDOW_SECONDS; i++) a->dps.seconds[i] = -1;
+    }
+    return &actors[idx];
+}
+
+static void fight_start(EntityID target_id, long tick) {
+    for (int i = 0; i < fight_count; i++) {
+        if (fights[i].target_id == target_id) return;
+    }
+    int slot = fight_count;
+    if (fight_count < MAX_PARSE_FIGHTS) {
+        fight_count++;
+    } else {
+        // Full: the oldest fight is the likeliest to have been abandoned
+        slot = 0;
+        for (int i = 1; i < fight_count; i++) {
+            if (fights[i].start_tick < fights[slot].start_tick) slot = i;
+        }
+    }
+    fights[slot].target_id = target_id;
+    fights[slot].start_tick = tick;
+}
+
+// Returns the fight length, or -1 if we never saw it start
+static long fight_end(EntityID target_id, long tick) {
+    for (int i = 0; i < fight_count; i++) {
+        if (fights[i].target_id == target_id) {
+            long ttk = tick - fights[i].start_tick;
+            fights[i] = fights[--fight_count];
+            return ttk;
+        }
+    }
+    return -1;
+}
+
+static void record_swing(ParseActor* a, long tick) {
+    a->swings++;
+    a->last_tick = tick;
+}
+
+void parse_record(const EvlogRecord* rec) {
+    long tick = (long)rec->tick;
+    const int32_t* arg = rec->args;
+
+    switch (rec->code) {
+        case EVLOG_MISS: {
+            ParseActor* a = actor_for(arg[0], tick);
+            if (a) record_swing(a, tick);
+            fight_start(arg[3], tick);
+            break;
+        }
+        case EVLOG_HIT:
+        case EVLOG_CRIT: {
+            ParseActor* a = actor_for(arg[0], tick);
+            ParseActor* t = actor_for(arg[1], tick);
+            if (a) {
+                record_swing(a, tick);
+                a->hits++;
+                if (rec->code == EVLOG_CRIT) a->crits++;
+                a->damage_dealt += arg[2];
+                a->tp_gained += arg[4];
+                window_add(&a->dps, tick, arg[2]);
+                parse_hist_add(&a->hit_damage, arg[2]);
+            }
+            if (t) t->damage_taken += arg[2];
+            fight_start(arg[6], tick);
+            break;
+        }
+        case EVLOG_POISON: {
+            ParseActor* t = actor_for(arg[0], tick);
+            if (t) t->damage_taken += arg[1];
+            break;
+        }
+        case EVLOG_DEFEAT: {
+            ParseActor* a = actor_for(arg[0], tick);
+            ParseActor* t = actor_for(arg[1], tick);
+            long ttk = fight_end(arg[3], tick);
+            if (a) {
+                a->kills++;
+                if (ttk >= 0) parse_hist_add(&a->ttk, (int)ttk);
+            }
+            if (t) t->deaths++;
+            session.kills++;
+            if (ttk >= 0) parse_hist_add(&session.ttk, (int)ttk);
+            break;
+        }
+        case EVLOG_STATUS_DEFEAT: {
+            ParseActor* t = actor_for(arg[0], tick);
+            long ttk = fight_end(arg[2], tick);
+            if (t) t->deaths++;
+            session.kills++;
+            if (ttk >= 0) parse_hist_add(&session.ttk, (int)ttk);
+            break;
+        }
+        default:
+            return; // Not combat
+    }
+
+    if (session.first_tick < 0) session.first_tick = tick;
+    session.last_tick = tick;
+}
+
+void parse_update(void) {
+    uint64_t head = evlog_head();
+    if (head - read_pos > EVLOG_CAPACITY) {
+        session.missed += (long)(head - read_pos - EVLOG_CAPACITY);
+        read_pos = head - EVLOG_CAPACITY;
+    }
+
+    EvlogRecord rec;
+    while (read_pos < head) {
+        if (!evlog_read(read_pos, &rec)) {
+            if (head - read_pos >= EVLOG_CAPACITY) {
+                session.missed++;
+                read_pos++;
+                continue;
+            }
+            break; // Still being written
+        }
+        parse_record(&rec);
+        session.records++;
+        read_pos++;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Queries
+// ----------------------------------------------------------------------------
+
+int parse_actor_count(void) {
+    return actor_count;
+}
+
+const ParseActor* parse_get_actor(int index) {
+    if (index < 0 || index >= actor_count) return NULL;
+    return &actors[index];
+}
+
+const ParseSession* parse_get_session(void) {
+    return &session;
+}
+
+static double active_seconds(const ParseActor* a) {
+    double s = (double)(a->last_tick - a->first_tick) / TURN_TICKS_PER_SECOND;
+    return s < 1.0 ? 1.0 : s;
+}
+
+// ----------------------------------------------------------------------------
+// Output
+// ----------------------------------------------------------------------------
+
+#define PARSE_REPORT_ACTORS 3
+
+void parse_report(void) {
+    if (session.first_tick < 0) {
+        ui_log("Parse: no combat yet.");
+        return;
+    }
+
+    double span = (double)(session.last_tick - session.first_tick) / TURN_TICKS_PER_SECOND;
+    ui_log("Parse: %.0fs, %ld kills, TTK p50 %.1fs p90 %.1fs", span, session.kills,
+        parse_hist_percentile(&session.ttk, 0.50) / (double)TURN_TICKS_PER_SECOND,
+        parse_hist_percentile(&session.ttk, 0.90) / (double)TURN_TICKS_PER_SECOND);
+
+    // Top damage dealers (partial selection, actors stay in place)
+    bool shown[MAX_PARSE_ACTORS] = {false};
+    long now = turn_get_current_time();
+    for (int n = 0; n < PARSE_REPORT_ACTORS; n++) {
+        int best = -1;
+        for (int i = 0; i < actor_count; i++) {
+            if (shown[i] || actors[i].swings == 0) continue;
+            if (best < 0 || actors[i].damage_dealt > actors[best].damage_dealt) best = i;
+        }
+        if (best < 0) break;
+        shown[best] = true;
+
+        const ParseActor* a = &actors[best];
+        ui_log("%s: %ld dmg %.1f DPS (%ds %.1f)", evlog_name(a->name_id), a->damage_dealt,
+            a->damage_dealt / active_seconds(a), PARSE_WINDOW_SECONDS, parse_window_rate(&a->dps, now));
+        ui_log("  acc %ld%% crit %ld%% hit p50 %d p90 %d max %d",
+            100 * a->hits / a->swings, a->hits ? 100 * a->crits / a->hits : 0,
+            parse_hist_percentile(&a->hit_damage, 0.50), parse_hist_percentile(&a->hit_damage, 0.90),
+            a->hit_damage.max);
+    }
+}
+
+bool parse_export_csv(const char* path) {
+    if (actor_count == 0) return true; // Nothing to write
+
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "name,swings,hits,crits,accuracy,damage_dealt,damage_taken,dps,hit_p50,hit_p90,hit_max,"
+               "tp_gained,kills,deaths,ttk_p50,ttk_p90,active_seconds\n");
+    for (int i = 0; i < actor_count; i++) {
+        const ParseActor* a = &actors[i];
+        fprintf(f, "%s,%ld,%ld,%ld,%.3f,%ld,%ld,%.2f,%d,%d,%d,%ld,%ld,%ld,%d,%d,%.2f\n",
+            evlog_name(a->name_id), a->swings, a->hits, a->crits,
+            a->swings ? (double)a->hits / a->swings : 0.0,
+            a->damage_dealt, a->damage_taken, a->damage_dealt / active_seconds(a),
+            parse_hist_percentile(&a->hit_damage, 0.50), parse_hist_percentile(&a->hit_damage, 0.90),
+            a->hit_damage.max, a->tp_gained, a->kills, a->deaths,
+            parse_hist_percentile(&a->ttk, 0.50), parse_hist_percentile(&a->ttk, 0.90),
+            active_seconds(a));
+    }
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef PARSE_H
+#define PARSE_H
+
+#include <stdbool.h>
+#include "evlog.h"
+
+// Combat Parse
+// Aggregates combat records from the event log into per-entity and session
+// statistics. All storage is fixed-size; nothing is allocated per event.
+// Entities are grouped by name, so every "Rabbit" shares one row.
+
+// Log-linear histogram: exact below 32, then 8 buckets per power of two
+#define PARSE_HIST_BUCKETS 240
+
+typedef struct {
+    unsigned int counts[PARSE_HIST_BUCKETS];
+    long samples;
+    int max;
+} ParseHistogram;
+
+// Rolling per-second sums over the last PARSE_WINDOW_SECONDS seconds
+#define PARSE_WINDOW_SECONDS 10
+
+typedef struct {
+    long sums[PARSE_WINDOW_SECONDS];
+    long seconds[PARSE_WINDOW_SECONDS]; // Which second each slot holds
+} ParseWindow;
+
+typedef struct {
+    int name_id;
+    long swings, hits, crits;
+    long damage_dealt, damage_taken;
+    long tp_gained;
+    long kills, deaths;
+    long first_tick, last_tick; // Span of this entity's swings
+    ParseWindow dps;
+    ParseHistogram hit_damage;
+    ParseHistogram ttk;         // Ticks from first swing to defeat, for this entity's kills
+} ParseActor;
+
+typedef struct {
+    long records;   // Records consumed
+    long missed;    // Records overwritten before we read them
+    long first_tick, last_tick;
+    long kills;
+    ParseHistogram ttk;
+} ParseSession;
+
+void parse_reset(void);
+void parse_zone_reset(void); // Entity ids are reused after zoning or /load; drops open fights
+void parse_update(void); // Consumes new records from the event log (main thread)
+void parse_record(const EvlogRecord* rec);
+
+int parse_actor_count(void);
+const ParseActor* parse_get_actor(int index);
+const ParseSession* parse_get_session(void);
+
+void parse_hist_add(ParseHistogram* h, int value);
+int parse_hist_percentile(const ParseHistogram* h, double p); // Bucket lower bound
+double parse_window_rate(const ParseWindow* w, long now);     // Per second
+
+// Output
+void parse_report(void); // Summary into the message log (/parse)
+bool parse_export_csv(const char* path);
+
+#endif
@@ -0,0 +1,103 @@
+#include <string.h>
+#include "phash.h"
+
+// FNV-1a with a seed folded into the offset basis
+uint32_t phash_string(const char* s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 16777619u);
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    // Final avalanche so low bits depend on every byte
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    return h;
+}
+
+#define PHASH_BUCKET_SEED 0x9e3779b9u
+
+static uint32_t bucket_of(const PerfectHash* ph, const char* key) {
+    return phash_string(key, ph->seed) & ph->bucket_mask;
+}
+
+static uint32_t slot_of(const PerfectHash* ph, const char* key, uint32_t displace) {
+    return phash_string(key, displace) & ph->mask;
+}
+
+bool phash_build(PerfectHash* ph, const char* const* keys, int count) {
+    // Slots at 2x the key count and about two keys per bucket: most buckets
+    // place within a few seeds
+    uint32_t size = 1;
+    while (size < (uint32_t)count * 2) size <<= 1;
+    if (size > PHASH_MAX_SLOTS) return false;
+    uint32_t buckets = size / 4 > 0 ? size / 4 : 1;
+
+    ph->seed = PHASH_BUCKET_SEED;
+    ph->mask = size - 1;
+    ph->bucket_mask = buckets - 1;
+    for (uint32_t i = 0; i < size; i++) ph->slots[i] = -1;
+    memset(ph->displace, 0, sizeof(ph->displace));
+
+    // Keys grouped by bucket: counting sort into order[]
+    int16_t order[PHASH_MAX_SLOTS / 2];
+    int start[PHASH_MAX_BUCKETS + 1];
+    memset(start, 0, sizeof(start));
+    for (int k = 0; k < count; k++) start[bucket_of(ph, keys[k]) + 1]++;
+    for (uint32_t b = 0; b < buckets; b++) start[b + 1] += start[b];
+    int fill[PHASH_MAX_BUCKETS];
+    memcpy(fill, start, buckets * sizeof(int));
+    for (int k = 0; k < count; k++) order[fill[bucket_of(ph, keys[k])]++] = (int16_t)k;
+
+    // Buckets largest first, while the table is emptiest
+    int by_size[PHASH_MAX_BUCKETS];
+    for (uint32_t b = 0; b < buckets; b++) {
+        int n = start[b + 1] - start[b];
+        uint32_t j = b;
+        while (j > 0 && start[by_size[j - 1] + 1] - start[by_size[j - 1]] < n) {
+            by_size[j] = by_size[j - 1];
+            j--;
+        }
+        by_size[j] = (int)b;
+    }
+
+    for (uint32_t i = 0; i < buckets; i++) {
+        int b = by_size[i];
+        const int16_t* members = &order[start[b]];
+        int n = start[b + 1] - start[b];
+        if (n == 0) break; // The rest are empty too
+
+        // Identical keys share a bucket and can never be separated
+        for (int a = 0; a < n; a++) {
+            for (int c = a + 1; c < n; c++) {
+                if (strcmp(keys[members[a]], keys[members[c]]) == 0) return false;
+            }
+        }
+
+        bool placed = false;
+        for (uint32_t d = 1; d <= UINT16_MAX && !placed; d++) {
+            uint32_t at[PHASH_MAX_SLOTS / 2];
+            placed = true;
+            for (int m = 0; m < n && placed; m++) {
+                at[m] = slot_of(ph, keys[members[m]], d);
+                if (ph->slots[at[m]] != -1) placed = false;
+                for (int o = 0; o < m && placed; o++) {
+                    if (at[o] == at[m]) placed = false;
+                }
+            }
+            if (placed) {
+                ph->displace[b] = (uint16_t)d;
+                for (int m = 0; m < n; m++) ph->slots[at[m]] = members[m];
+            }
+        }
+        if (!placed) return false;
+    }
+    return true;
+}
+
+int phash_lookup(const PerfectHash* ph, const char* const* keys, const char* key) {
+    if (!keys) return -1;
+    int idx = ph->slots[slot_of(ph, key, ph->displace[bucket_of(ph, key)])];
+    if (idx < 0 || strcmp(keys[idx], key) != 0) return -1;
+    return idx;
+}
@@ -0,0 +1,35 @@
+#ifndef PHASH_H
+#define PHASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Perfect Hash
+// Built once over a fixed key set (e.g. template or command names) by hash
+// and displace: a first hash sorts the keys into small buckets, then each
+// bucket, largest first, gets its own seed for a second hash that lands all
+// of its keys on free slots. Only a bucket's few keys must fit at once, so
+// building stays fast however many keys there are.
+// Lookup is two hashes, one table read and one strcmp to reject unknown keys.
+
+#define PHASH_MAX_SLOTS 1024
+#define PHASH_MAX_BUCKETS (PHASH_MAX_SLOTS / 4)
+
+typedef struct {
+    uint32_t seed;         // Bucket hash
+    uint32_t bucket_mask;
+    uint32_t mask;
+    uint16_t displace[PHASH_MAX_BUCKETS]; // Slot hash seed per bucket
+    int16_t slots[PHASH_MAX_SLOTS];       // Key index, -1 = empty
+} PerfectHash;
+
+uint32_t phash_string(const char* s, uint32_t seed);
+
+// Returns false if the key set is too large (over PHASH_MAX_SLOTS / 2) or
+// contains duplicates
+bool phash_build(PerfectHash* ph, const char* const* keys, int count);
+
+// Returns the key index, or -1 if key is not in the set
+int phash_lookup(const PerfectHash* ph, const char* const* keys, const char* key);
+
+#endif
@@ -0,0 +1,279 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "region.h"
+#include "rng.h"
+
+// Scratch space for the analysis pass
+static int queue[MAX_MAP_WIDTH * MAX_MAP_HEIGHT];       // x | y << 8
+static uint32_t edges[MAX_MAP_WIDTH * MAX_MAP_HEIGHT * 8]; // from << 16 | to
+static int parent[MAP_MAX_REGIONS];                      // Union-find over regions
+static int component_of_root[MAP_MAX_REGIONS];
+
+// 8 directions, movement style
+static const int DIRS[8][2] = {
+    {0,-1}, {1,-1}, {1,0}, {1,1}, {0,1}, {-1,1}, {-1,0}, {-1,-1}
+};
+
+// ----------------------------------------------------------------------------
+// Labelling
+// ----------------------------------------------------------------------------
+
+// Doorways are passable for the analysis even while the door is shut
+static bool passable(Map* map, int x, int y) {
+    if (x < 0 || y < 0 || x >= map->width || y >= map->height) return false;
+    return map_is_walkable(map, x, y) || map->tiles[x][y].type == TILE_DOOR;
+}
+
+static RegionKind tile_kind(Map* map, int x, int y) {
+    TileType t = map->tiles[x][y].type;
+    if (t == TILE_BRIDGE) return REGION_BRIDGE;
+    if (t == TILE_DOOR) return REGION_DOOR;
+
+    bool walls_ew = !passable(map, x - 1, y) && !passable(map, x + 1, y);
+    bool walls_ns = !passable(map, x, y - 1) && !passable(map, x, y + 1);
+    return (walls_ew || walls_ns) ? REGION_CORRIDOR : REGION_ROOM;
+}
+
+// Flood fills one region of same-kind tiles from (sx, sy)
+static void fill_region(Map* map, int r, int sx, int sy) {
+    MapRegions* mr = &map->regions;
+    MapRegion* reg = &mr->regions[r];
+    memset(reg, 0, sizeof(MapRegion));
+    reg->kind = tile_kind(map, sx, sy);
+    reg->x0 = reg->x1 = sx;
+    reg->y0 = reg->y1 = sy;
+
+    int head = 0, tail = 0;
+    queue[tail++] = sx | (sy << 8);
+    mr->tile_region[sx][sy] = (uint16_t)r;
+
+    while (head < tail) {
+        int x = queue[head] & 0xFF;
+        int y = queue[head] >> 8;
+        head++;
+
+        reg->tiles++;
+        if (x < reg->x0) reg->x0 = x;
+        if (x > reg->x1) reg->x1 = x;
+        if (y < reg->y0) reg->y0 = y;
+        if (y > reg->y1) reg->y1 = y;
+
+        for (int d = 0; d < 8; d++) {
+            int nx = x + DIRS[d][0];
+            int ny = y + DIRS[d][1];
+            if (!passable(map, nx, ny) || mr->tile_region[nx][ny] != REGION_NONE) continue;
+            if (tile_kind(map, nx, ny) != reg->kind) continue;
+            mr->tile_region[nx][ny] = (uint16_t)r;
+            queue[tail++] = nx | (ny << 8);
+        }
+    }
+}
+
+static int find_root(int r) {
+    while (parent[r] != r) {
+        parent[r] = parent[parent[r]];
+        r = parent[r];
+    }
+    return r;
+}
+
+static void join(int a, int b) {
+    a = find_root(a);
+    b = find_root(b);
+    if (a != b) parent[b] = a;
+}
+
+static int compare_edges(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static RegionLinkKind link_kind(const MapRegions* mr, int a, int b) {
+    RegionKind ka = mr->regions[a].kind;
+    RegionKind kb = mr->regions[b].kind;
+    if (ka == REGION_DOOR || kb == REGION_DOOR) return REGION_LINK_DOOR;
+    if (ka == REGION_BRIDGE || kb == REGION_BRIDGE) return REGION_LINK_BRIDGE;
+    return REGION_LINK_OPEN;
+}
+
+void region_analyse(Map* map) {
+    MapRegions* mr = &map->regions;
+    memset(mr->tile_region, 0xFF, sizeof(mr->tile_region)); // REGION_NONE
+    mr->region_count = 0;
+    mr->link_count = 0;
+    mr->component_count = 0;
+
+    // 1. Regions
+    for (int y = 0; y < map->height; y++) {
+        for (int x = 0; x < map->width; x++) {
+            if (!passable(map, x, y) || mr->tile_region[x][y] != REGION_NONE) continue;
+            if (mr->region_count >= MAP_MAX_REGIONS) {
+                fprintf(stderr, "FATAL: %s has more than %d regions\n", map->name, MAP_MAX_REGIONS);
+                exit(1);
+            }
+            fill_region(map, mr->region_count++, x, y);
+        }
+    }
+
+    // 2. Adjacency (each tile looks E, SE, S, SW so every pair is seen once)
+    int edge_count = 0;
+    for (int i = 0; i < mr->region_count; i++) parent[i] = i;
+
+    for (int y = 0; y < map->height; y++) {
+        for (int x = 0; x < map->width; x++) {
+            int a = mr->tile_region[x][y];
+            if (a == REGION_NONE) continue;
+            for (int d = 2; d <= 5; d++) {
+                int nx = x + DIRS[d][0];
+                int ny = y + DIRS[d][1];
+                if (nx < 0 || ny < 0 || nx >= map->width || ny >= map->height) continue;
+                int b = mr->tile_region[nx][ny];
+                if (b == REGION_NONE || b == a) continue;
+
+                uint32_t ab = ((uint32_t)a << 16) | (uint32_t)b;
+                if (edge_count > 0 && edges[edge_count - 2] == ab) continue; // Same border as last tile
+                edges[edge_count++] = ab;
+                edges[edge_count++] = ((uint32_t)b << 16) | (uint32_t)a;
+                join(a, b);
+            }
+        }
+    }
+
+    // Teleports link one way but join components both ways
+    for (int i = 0; i < map->teleport_count; i++) {
+        const MapTeleport* tp = &map->teleports[i];
+        int a = region_at(map, tp->x, tp->y);
+        int b = region_at(map, tp->target_x, tp->target_y);
+        if (a < 0 || b < 0 || a == b) continue;
+        join(a, b);
+    }
+
+    // 3. Link table: sorted by region, duplicates dropped, teleports last
+    qsort(edges, edge_count, sizeof(uint32_t), compare_edges);
+
+    int link = 0;
+    int e = 0;
+    for (int r = 0; r < mr->region_count; r++) {
+        MapRegion* reg = &mr->regions[r];
+        reg->first_link = link;
+
+        for (; e < edge_count && (int)(edges[e] >> 16) == r; e++) {
+            if (e > 0 && edges[e] == edges[e - 1]) continue;
+            if (link >= MAP_MAX_REGION_LINKS) {
+                fprintf(stderr, "FATAL: %s has more than %d region links\n", map->name, MAP_MAX_REGION_LINKS);
+                exit(1);
+            }
+            int to = edges[e] & 0xFFFF;
+            mr->links[link].to = (uint16_t)to;
+            mr->links[link].kind = (uint8_t)link_kind(mr, r, to);
+            link++;
+        }
+        for (int i = 0; i < map->teleport_count; i++) {
+            const MapTeleport* tp = &map->teleports[i];
+            if (region_at(map, tp->x, tp->y) != r) continue;
+            int to = region_at(map, tp->target_x, tp->target_y);
+            if (to < 0 || to == r || link >= MAP_MAX_REGION_LINKS) continue;
+            mr->links[link].to = (uint16_t)to;
+            mr->links[link].kind = REGION_LINK_TELEPORT;
+            link++;
+        }
+        reg->link_count = link - reg->first_link;
+    }
+    mr->link_count = link;
+
+    // 4. Components, numbered in scan order
+    for (int i = 0; i < mr->region_count; i++) component_of_root[i] = -1;
+    for (int i = 0; i < mr->region_count; i++) {
+        int root = find_root(i);
+        if (component_of_root[root] < 0) {
+            component_of_root[root] = mr->component_count;
+            mr->component_tiles[mr->component_count] = 0;
+            mr->component_count++;
+        }
+        mr->regions[i].component = component_of_root[root];
+        mr->component_tiles[mr->regions[i].component] += mr->regions[i].tiles;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Queries
+// ----------------------------------------------------------------------------
+
+int region_at(const Map* map, int x, int y) {
+    if (x < 0 || y < 0 || x >= map->width || y >= map->height) return -1;
+    int r = map->regions.tile_region[x][y];
+    return r == REGION_NONE ? -1 : r;
+}
+
+int region_component_at(const Map* map, int x, int y) {
+    int r = region_at(map, x, y);
+    return r < 0 ? -1 : map->regions.regions[r].component;
+}
+
+bool region_connected(const Map* map, int x0, int y0, int x1, int y1) {
+    int a = region_component_at(map, x0, y0);
+    return a >= 0 && a == region_component_at(map, x1, y1);
+}
+
+int region_largest_component(const Map* map) {
+    const MapRegions* mr = &map->regions;
+    int best = -1;
+    for (int c = 0; c < mr->component_count; c++) {
+        if (best < 0 || mr->component_tiles[c] > mr->component_tiles[best]) best = c;
+    }
+    return best;
+}
+
+const MapRegion* region_get(const Map* map, int region) {
+    if (region < 0 || region >= map->regions.region_count) return NULL;
+    return &map->regions.regions[region];
+}
+
+const MapRegionLink* region_links(const Map* map, int region, int* count) {
+    const MapRegion* reg = region_get(map, region);
+    if (!reg) {
+        *count = 0;
+        return NULL;
+    }
+    *count = reg->link_count;
+    return &map->regions.links[reg->first_link];
+}
+
+#define REGION_SAMPLE_TRIES 32
+
+bool region_random_free_tile(const Map* map, int component, int* x, int* y) {
+    const MapFreeSet* fs = &map->free;
+    if (fs->count == 0) return false;
+
+    // Usually the component holds most free tiles
+    for (int i = 0; i < REGION_SAMPLE_TRIES; i++) {
+        int t = fs->tiles[rng_range(0, fs->count - 1)];
+        if (region_component_at(map, t & 0xFF, t >> 8) == component) {
+            *x = t & 0xFF;
+            *y = t >> 8;
+            return true;
+        }
+    }
+
+    // Small component: count its free tiles and pick one
+    int matching = 0;
+    for (int i = 0; i < fs->count; i++) {
+        int t = fs->tiles[i];
+        if (region_component_at(map, t & 0xFF, t >> 8) == component) matching++;
+    }
+    if (matching == 0) return false;
+
+    int pick = rng_range(0, matching - 1);
+    for (int i = 0; i < fs->count; i++) {
+        int t = fs->tiles[i];
+        if (region_component_at(map, t & 0xFF, t >> 8) != component) continue;
+        if (pick-- == 0) {
+            *x = t & 0xFF;
+            *y = t >> 8;
+            break;
+        }
+    }
+    return true;
+}
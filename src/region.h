@@ -0,0 +1,26 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <stdbool.h>
+#include "map.h"
+
+// Region Analysis
+// Run once when a map is generated or loaded; the result lives in
+// Map.regions. Tiles connect in 8 directions like movement does, doorways
+// count as passable, and teleports join their two ends. Reachability is a
+// compare of component labels.
+
+void region_analyse(Map* map);
+
+int region_at(const Map* map, int x, int y);           // -1 if blocked
+int region_component_at(const Map* map, int x, int y); // -1 if blocked
+bool region_connected(const Map* map, int x0, int y0, int x1, int y1);
+int region_largest_component(const Map* map);          // -1 if nothing is walkable
+
+const MapRegion* region_get(const Map* map, int region);
+const MapRegionLink* region_links(const Map* map, int region, int* count);
+
+// Uniform over the component's free tiles; false if it has none
+bool region_random_free_tile(const Map* map, int component, int* x, int* y);
+
+#endif
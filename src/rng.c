@@ -0,0 +1,40 @@
+#include "rng.h"
+
+// Per-thread stream
+static __thread uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+// SplitMix64 spreads nearby seeds (0, 1, 2...) into unrelated streams
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+void rng_seed(uint64_t seed) {
+    rng_state = splitmix64(seed);
+    if (rng_state == 0) rng_state = 0x9E3779B97F4A7C15ull; // xorshift must not be zero
+}
+
+uint64_t rng_next(void) {
+    uint64_t x = rng_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng_state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+int rng_range(int lo, int hi) {
+    if (hi <= lo) return lo;
+    uint64_t span = (uint64_t)(hi - lo) + 1;
+    return lo + (int)((rng_next() >> 32) % span);
+}
+
+uint64_t rng_get_state(void) {
+    return rng_state;
+}
+
+void rng_set_state(uint64_t state) {
+    rng_state = state ? state : 0x9E3779B97F4A7C15ull;
+}
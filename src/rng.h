@@ -0,0 +1,17 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Seedable RNG (xorshift64*)
+// Each thread owns an independent stream, so headless tools can run one
+// deterministic simulation per thread.
+
+void rng_seed(uint64_t seed);
+uint64_t rng_next(void);
+int rng_range(int lo, int hi); // Inclusive
+
+uint64_t rng_get_state(void);
+void rng_set_state(uint64_t state);
+
+#endif
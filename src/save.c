@@ -0,0 +1,438 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "save.h"
+#include "ai.h"
+#include "data.h"
+#include "entity.h"
+#include "minimap.h"
+#include "parse.h"
+#include "region.h"
+#include "rng.h"
+#include "spatial.h"
+#include "target.h"
+#include "turn.h"
+
+#define SAVE_TILES (MAX_MAP_WIDTH * MAX_MAP_HEIGHT)
+#define SAVE_LAYER_MAX (SAVE_TILES * 4) // One run per tile: 3-byte length + value
+
+// Map data stored as is
+typedef struct {
+    char name[64];
+    int32_t width, height;
+    MapExit exits[256];
+    int32_t exit_count;
+    MapTeleport teleports[MAX_TELEPORTS];
+    int32_t teleport_count;
+    int32_t fov_boxed, fov_x, fov_y, fov_radius;
+} SaveMapInfo;
+
+// Scratch, too big for the stack; layers hold one byte per tile, column-major
+static uint8_t planes[SAVE_LAYER_COUNT][SAVE_TILES];
+static uint8_t encoded[SAVE_LAYER_COUNT][SAVE_LAYER_MAX];
+static TurnState turn_copy;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static bool fail(SaveResult* out, const char* why) {
+    snprintf(out->error, sizeof(out->error), "%s", why);
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// Run-Length Encoding
+// Run lengths are LEB128 varints. Bitplanes store only the lengths, of
+// alternating runs starting with 0s (so the first may be empty); byte layers
+// store a (length, value) pair per run.
+// ----------------------------------------------------------------------------
+
+static bool is_bit_layer(int layer) {
+    return layer == SAVE_LAYER_VISIBLE || layer == SAVE_LAYER_EXPLORED || layer == SAVE_LAYER_OCCUPIED;
+}
+
+static uint8_t* put_varint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static bool get_varint(const uint8_t** p, const uint8_t* end, uint32_t* v) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (*p >= end) return false;
+        uint8_t b = *(*p)++;
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t rle_encode(const uint8_t* in, int n, bool bits, uint8_t* out) {
+    uint8_t* p = out;
+    uint8_t bit = 0;
+    for (int i = 0; i < n;) {
+        uint8_t value = bits ? bit : in[i];
+        int start = i;
+        while (i < n && in[i] == value) i++;
+        p = put_varint(p, (uint32_t)(i - start));
+        if (bits) bit ^= 1;
+        else *p++ = value;
+    }
+    return (uint32_t)(p - out);
+}
+
+// Must produce exactly n values from exactly len bytes
+static bool rle_decode(const uint8_t* in, uint32_t len, bool bits, uint8_t* out, int n) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + len;
+    uint8_t bit = 0;
+    int i = 0;
+    while (i < n) {
+        uint32_t run;
+        if (!get_varint(&p, end, &run) || run > (uint32_t)(n - i)) return false;
+
+        uint8_t value;
+        if (bits) {
+            value = bit;
+            bit ^= 1;
+        } else {
+            if (p >= end) return false;
+            value = *p++;
+        }
+        memset(out + i, value, run);
+        i += (int)run;
+    }
+    return p == end;
+}
+
+// ----------------------------------------------------------------------------
+// Saving
+// ----------------------------------------------------------------------------
+
+static void gather_layers(const Map* map) {
+    int n = 0;
+    for (int x = 0; x < map->width; x++) {
+        for (int y = 0; y < map->height; y++) {
+            const Tile* t = &map->tiles[x][y];
+            int smell = map->smell[x][y];
+            planes[SAVE_LAYER_TYPE][n] = (uint8_t)t->type;
+            planes[SAVE_LAYER_VISIBLE][n] = t->visible;
+            planes[SAVE_LAYER_EXPLORED][n] = t->explored;
+            planes[SAVE_LAYER_OCCUPIED][n] = t->occupied;
+            planes[SAVE_LAYER_SMELL][n] = (uint8_t)(smell < 0 ? 0 : smell > 255 ? 255 : smell);
+            planes[SAVE_LAYER_SOUND][n] = (uint8_t)map->sound[x][y];
+            n++;
+        }
+    }
+}
+
+bool save_write(const Game* game, const char* path, SaveResult* out) {
+    double start = now_ms();
+    memset(out, 0, sizeof(*out));
+    const Map* map = &game->current_map;
+
+    SaveHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+    h.version = SAVE_VERSION;
+    h.entity_size = sizeof(Entity);
+    h.turn_size = sizeof(TurnState);
+    h.entity_count = (uint32_t)game->entity_count;
+    h.rng_state = rng_get_state();
+
+    SaveMapInfo info;
+    memset(&info, 0, sizeof(info));
+    memcpy(info.name, map->name, sizeof(info.name));
+    info.width = map->width;
+    info.height = map->height;
+    memcpy(info.exits, map->exits, sizeof(info.exits));
+    info.exit_count = map->exit_count;
+    memcpy(info.teleports, map->teleports, sizeof(info.teleports));
+    info.teleport_count = map->teleport_count;
+    info.fov_boxed = map->fov_boxed;
+    info.fov_x = map->fov_x;
+    info.fov_y = map->fov_y;
+    info.fov_radius = map->fov_radius;
+
+    gather_layers(map);
+    for (int l = 0; l < SAVE_LAYER_COUNT; l++) {
+        h.layer_bytes[l] = rle_encode(planes[l], map->width * map->height, is_bit_layer(l), encoded[l]);
+    }
+    turn_export(&turn_copy);
+
+    // Written beside the old save and renamed over it, so a failed write
+    // never costs the last good one
+    char tmp[256];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE* f = fopen(tmp, "wb");
+    if (!f) {
+        snprintf(out->error, sizeof(out->error), "%.64s: %s", path, strerror(errno));
+        return false;
+    }
+
+    size_t count = (size_t)game->entity_count;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              fwrite(&game->player, sizeof(Entity), 1, f) == 1 &&
+              fwrite(game->entities, sizeof(Entity), count, f) == count &&
+              fwrite(&turn_copy, sizeof(turn_copy), 1, f) == 1 &&
+              fwrite(&info, sizeof(info), 1, f) == 1;
+    out->bytes = sizeof(h) + (count + 1) * sizeof(Entity) + sizeof(turn_copy) + sizeof(info);
+    for (int l = 0; l < SAVE_LAYER_COUNT && ok; l++) {
+        ok = fwrite(encoded[l], 1, h.layer_bytes[l], f) == h.layer_bytes[l];
+        out->bytes += h.layer_bytes[l];
+    }
+    if (fclose(f) != 0) ok = false;
+
+    if (!ok || rename(tmp, path) != 0) {
+        snprintf(out->error, sizeof(out->error), "%.64s: %s", path, strerror(errno));
+        remove(tmp);
+        return false;
+    }
+    out->ms = now_ms() - start;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Loading
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+} SaveReader;
+
+// NULL if the file ends first. Data in the mapping may be unaligned, so
+// fixed-size parts are copied out rather than cast.
+static const uint8_t* take(SaveReader* r, size_t n) {
+    if ((size_t)(r->end - r->p) < n) return NULL;
+    const uint8_t* at = r->p;
+    r->p += n;
+    return at;
+}
+
+static bool on_map(const SaveMapInfo* info, int x, int y) {
+    return x >= 0 && y >= 0 && x < info->width && y < info->height;
+}
+
+static bool in_range(int v, int lo, int hi) {
+    return v >= lo && v < hi;
+}
+
+// Everything later code indexes with or trusts as a count. Links into the
+// spatial grid and sleeper lists are rebuilt by apply, not checked.
+static bool check_entity(const uint8_t* at, const SaveMapInfo* info) {
+    Entity e;
+    memcpy(&e, at, sizeof(e));
+    if (!on_map(info, e.x, e.y)) return false;
+    if (e.is_burrowed && !on_map(info, e.burrow_dest_x, e.burrow_dest_y)) return false;
+    if (e.type != ENTITY_PLAYER && e.type != ENTITY_ENEMY) return false;
+    if (!in_range(e.race, 0, RACE_MAX) || !in_range(e.nation, 0, NATION_MAX)) return false;
+    if (!in_range(e.main_job, 0, JOB_MAX) || !in_range(e.sub_job, 0, JOB_MAX)) return false;
+    if (!in_range(e.ai_state, -1, data_ai_state_count())) return false;
+    if (!in_range(e.ai_lod, AI_LOD_ACTIVE, AI_LOD_DORMANT + 1)) return false;
+
+    if (!in_range(e.effect_count, 0, MAX_STATUS_EFFECTS + 1)) return false;
+    for (int i = 0; i < e.effect_count; i++) {
+        if (!in_range(e.effects[i].type, STATUS_NONE + 1, STATUS_MAX)) return false;
+    }
+    if (!in_range(e.enmity.count, 0, ENMITY_MAX_ENTRIES + 1)) return false;
+    if (e.enmity.count > 0 && !in_range(e.enmity.top, 0, e.enmity.count)) return false;
+    return in_range(e.hated_by_count, 0, ENMITY_MAX_REFS + 1);
+}
+
+// Exits lead to other maps, so only their doorway is checked; a teleport
+// must land on this one.
+static bool check_links(const SaveMapInfo* info) {
+    for (int i = 0; i < info->exit_count; i++) {
+        if (!on_map(info, info->exits[i].x, info->exits[i].y)) return false;
+    }
+    for (int i = 0; i < info->teleport_count; i++) {
+        const MapTeleport* t = &info->teleports[i];
+        if (!on_map(info, t->x, t->y) || !on_map(info, t->target_x, t->target_y)) return false;
+    }
+    return true;
+}
+
+static void apply(Game* game, const SaveHeader* h, const uint8_t* player, const uint8_t* entities,
+                  const SaveMapInfo* info) {
+    entity_flush_dirty_stats(); // The queue points into the entities being replaced
+
+    memcpy(&game->player, player, sizeof(Entity));
+    memcpy(game->entities, entities, h->entity_count * sizeof(Entity));
+    game->entity_count = (int)h->entity_count;
+
+    Map* map = &game->current_map;
+    memcpy(map->name, info->name, sizeof(map->name));
+    map->name[sizeof(map->name) - 1] = 0;
+    map->width = info->width;
+    map->height = info->height;
+    memcpy(map->exits, info->exits, sizeof(map->exits));
+    map->exit_count = info->exit_count;
+    for (int i = 0; i < map->exit_count; i++) {
+        map->exits[i].target_file[sizeof(map->exits[i].target_file) - 1] = '\0'; // Zoning opens it by name
+    }
+    memcpy(map->teleports, info->teleports, sizeof(map->teleports));
+    map->teleport_count = info->teleport_count;
+
+    memset(map->tiles, 0, sizeof(map->tiles));
+    memset(map->smell, 0, sizeof(map->smell));
+    memset(map->sound, 0, sizeof(map->sound));
+    int n = 0;
+    for (int x = 0; x < map->width; x++) {
+        for (int y = 0; y < map->height; y++) {
+            Tile* t = &map->tiles[x][y];
+            t->type = (TileType)planes[SAVE_LAYER_TYPE][n];
+            t->visible = planes[SAVE_LAYER_VISIBLE][n];
+            t->explored = planes[SAVE_LAYER_EXPLORED][n];
+            t->occupied = planes[SAVE_LAYER_OCCUPIED][n];
+            map->smell[x][y] = planes[SAVE_LAYER_SMELL][n];
+            map->sound[x][y] = (SoundState)planes[SAVE_LAYER_SOUND][n];
+            n++;
+        }
+    }
+
+    // The visible layer is the one the saved FOV box lit
+    map->fov_boxed = info->fov_boxed != 0;
+    map->fov_x = info->fov_x;
+    map->fov_y = info->fov_y;
+    map->fov_radius = info->fov_radius;
+
+    // Derived map data
+    region_analyse(map);
+    map_index_free_tiles(map);
+    minimap_reset(map);
+    for (int x = 0; x < map->width; x++) {
+        for (int y = 0; y < map->height; y++) {
+            if (map->tiles[x][y].explored) minimap_mark(map, x, y);
+        }
+    }
+
+    turn_import(&turn_copy);
+    rng_set_state(h->rng_state);
+    parse_zone_reset(); // The loaded entities reuse ids the parse may still be tracking
+
+    // Per-run and per-thread state the entities point into
+    spatial_reset();
+    Entity* all[MAX_ENTITIES + 1];
+    all[0] = &game->player;
+    for (int i = 0; i < game->entity_count; i++) all[i + 1] = &game->entities[i];
+    for (int i = 0; i <= game->entity_count; i++) {
+        Entity* e = all[i];
+        e->name[MAX_NAME_LEN - 1] = '\0';
+        e->name_id = 0; // Log names are interned per run
+
+        if (e->stats_dirty) {
+            e->stats_dirty = false; // Saved mid-batch: queue it here
+            entity_mark_dirty(e);
+        }
+        bool indexed = e->spatial_cell != 0;
+        e->spatial_cell = 0;
+        e->spatial_next = 0;
+        if (e != &game->player && indexed) spatial_insert(e);
+    }
+    game->player.lod_next = 0; // Monsters' are rebuilt below
+    ai_lod_rebuild(game);
+    target_clear();
+}
+
+static bool load_mapped(Game* game, const uint8_t* base, size_t size, SaveResult* out) {
+    SaveReader r = {base, base + size};
+
+    SaveHeader h;
+    const uint8_t* at = take(&r, sizeof(h));
+    if (!at) return fail(out, "not a save file");
+    memcpy(&h, at, sizeof(h));
+    if (memcmp(h.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0) return fail(out, "not a save file");
+    if (h.version != SAVE_VERSION) {
+        snprintf(out->error, sizeof(out->error), "save version %u, expected %u", h.version, SAVE_VERSION);
+        return false;
+    }
+    if (h.entity_size != sizeof(Entity) || h.turn_size != sizeof(TurnState)) {
+        return fail(out, "written by a different build");
+    }
+    if (h.entity_count > MAX_ENTITIES) return fail(out, "too many entities");
+
+    const uint8_t* player = take(&r, sizeof(Entity));
+    const uint8_t* entities = take(&r, h.entity_count * sizeof(Entity));
+    const uint8_t* turn = take(&r, sizeof(TurnState));
+    const uint8_t* info_at = take(&r, sizeof(SaveMapInfo));
+    if (!player || !entities || !turn || !info_at) return fail(out, "file is truncated");
+
+    memcpy(&turn_copy, turn, sizeof(turn_copy));
+    if (!turn_state_valid(&turn_copy)) return fail(out, "scheduler is corrupt");
+
+    SaveMapInfo info;
+    memcpy(&info, info_at, sizeof(info));
+    if (info.width < 1 || info.width > MAX_MAP_WIDTH || info.height < 1 || info.height > MAX_MAP_HEIGHT ||
+        info.exit_count < 0 || info.exit_count > 256 ||
+        info.teleport_count < 0 || info.teleport_count > MAX_TELEPORTS || !check_links(&info)) {
+        return fail(out, "map is corrupt");
+    }
+    if (!check_entity(player, &info)) return fail(out, "player is corrupt");
+    for (uint32_t i = 0; i < h.entity_count; i++) {
+        if (!check_entity(entities + i * sizeof(Entity), &info)) return fail(out, "monster is corrupt");
+    }
+
+    int n = info.width * info.height;
+    for (int l = 0; l < SAVE_LAYER_COUNT; l++) {
+        const uint8_t* data = take(&r, h.layer_bytes[l]);
+        if (!data || !rle_decode(data, h.layer_bytes[l], is_bit_layer(l), planes[l], n)) {
+            return fail(out, "tile layers are corrupt");
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (planes[SAVE_LAYER_TYPE][i] > TILE_TELEPORT || planes[SAVE_LAYER_SOUND][i] > SOUND_MUFFLED) {
+            return fail(out, "tile layers are corrupt");
+        }
+    }
+
+    apply(game, &h, player, entities, &info);
+    return true;
+}
+
+bool save_read(Game* game, const char* path, SaveResult* out) {
+    double start = now_ms();
+    memset(out, 0, sizeof(*out));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        snprintf(out->error, sizeof(out->error), "%.64s: %s", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return fail(out, "not a save file");
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file
+    if (base == MAP_FAILED) {
+        snprintf(out->error, sizeof(out->error), "%.64s: %s", path, strerror(errno));
+        return false;
+    }
+
+    bool ok = load_mapped(game, base, size, out);
+    munmap(base, size);
+
+    out->bytes = size;
+    out->ms = now_ms() - start;
+    return ok;
+}
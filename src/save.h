@@ -0,0 +1,66 @@
+#ifndef SAVE_H
+#define SAVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+// Save Games
+// One versioned binary file: a header, the player and monsters, the whole
+// scheduler (handles included, so pending attacks and status timers carry
+// over), the RNG state, the map's fixed data and its tile layers. Layers are
+// run-length encoded column by column; visible, explored and occupied are
+// bitplanes, so a zone costs a few KB. Whatever can be derived (regions, free
+// tiles, minimap, spatial grid, sleeper lists) is rebuilt on load instead.
+//
+// Entities and the scheduler are stored as raw structs, so a file only loads
+// into a build with the same layout; the header records the sizes to check.
+// Loading checks every field later code indexes with or trusts as a count
+// (positions, enums, effect and enmity counts, the scheduler's heap and
+// slots), so a damaged file is refused instead of read out of bounds. A
+// value that is wrong but in range still loads.
+//
+// The RNG stream is saved too, so play after a load goes on exactly as it
+// would have from the save.
+//
+// Saves are taken on the player's turn, after its move event has been popped,
+// and hold that turn's time; the caller schedules the move again after a
+// load. Both run on the thread that owns the scheduler and RNG stream.
+
+#define SAVE_MAGIC "GFSAVE"
+#define SAVE_VERSION 1
+#define SAVE_DEFAULT_PATH "grindfest.sav"
+
+typedef enum {
+    SAVE_LAYER_TYPE,     // Bytes: TileType
+    SAVE_LAYER_VISIBLE,  // Bits
+    SAVE_LAYER_EXPLORED, // Bits
+    SAVE_LAYER_OCCUPIED, // Bits
+    SAVE_LAYER_SMELL,    // Bytes: 0-255
+    SAVE_LAYER_SOUND,    // Bytes: SoundState
+    SAVE_LAYER_COUNT
+} SaveLayer;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t entity_size;  // sizeof(Entity)
+    uint32_t turn_size;    // sizeof(TurnState)
+    uint32_t entity_count;
+    uint64_t rng_state;
+    uint32_t layer_bytes[SAVE_LAYER_COUNT];
+} SaveHeader;
+
+typedef struct {
+    size_t bytes;      // File size
+    double ms;         // Wall time taken
+    char error[128];   // Why it failed
+} SaveResult;
+
+bool save_write(const Game* game, const char* path, SaveResult* out);
+
+// Leaves the game untouched unless the whole file checks out
+bool save_read(Game* game, const char* path, SaveResult* out);
+
+#endif
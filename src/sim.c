@@ -0,0 +1,280 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "entity.h"
+#include "rng.h"
+#include "target.h"
+#include "turn.h"
+#include "ui.h"
+
+#define SIM_QUEUE_SIZE 256 // Power of two
+#define SIM_QUEUE_MASK (SIM_QUEUE_SIZE - 1)
+
+// Free-running counters; head - tail is the number queued
+static SimCommand queue[SIM_QUEUE_SIZE];
+static uint32_t queue_head = 0;   // Published by sim_submit (main thread)
+static uint32_t queue_tail = 0;   // Advanced by the simulation thread
+static uint32_t queue_staged = 0; // Main thread only: head once submitted
+
+// Doorbell for an empty ring; the ring itself takes no lock
+static pthread_mutex_t doorbell_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t doorbell = PTHREAD_COND_INITIALIZER;
+
+// Triple buffer: the simulation fills `back`, main reads `front`, and the
+// newest complete one waits in `middle` (SNAP_FRESH set until main takes it)
+#define SNAP_FRESH 4
+static WorldSnapshot snapshots[3];
+static int snap_back = 0;   // Simulation thread only
+static int snap_front = 1;  // Main thread only
+static int snap_middle = 2;
+static uint64_t snap_seq = 0;
+
+static uint32_t drops = 0;      // Simulation thread only
+static uint32_t overviews = 0;
+
+static pthread_t thread;
+static void (*sim_run)(void);
+static bool running = false;
+static uint64_t rng_handoff;
+static TurnState turn_handoff;
+
+// Real-time clock: tick clock_origin_tick was due at clock_origin_ns
+static int clock_rate = 0;
+static long clock_origin_tick;
+static int64_t clock_origin_ns;
+static int64_t clock_resumed_ns; // Last return from sim_clock_wait
+static SimClockStats clock_stats; // Simulation thread only
+
+// ----------------------------------------------------------------------------
+// Lifecycle
+// ----------------------------------------------------------------------------
+
+static void* sim_main(void* arg) {
+    (void)arg;
+    // Continue the main thread's scheduler and RNG stream
+    turn_import(&turn_handoff);
+    turn_set_time_mode(TURN_TIME_PUBLISH); // Main thread logs are stamped with our time
+    rng_set_state(rng_handoff);
+    sim_clock_restart();
+    sim_run();
+    entity_flush_dirty_stats(); // The queue is per-thread and stays behind
+    turn_export(&turn_handoff);
+    rng_handoff = rng_get_state();
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+void sim_start(void (*run)(void)) {
+    queue_head = queue_tail = queue_staged = 0;
+    drops = overviews = 0;
+    for (int i = 0; i < 3; i++) snapshots[i].seq = 0;
+    snap_back = 0;
+    snap_front = 1;
+    snap_middle = 2;
+
+    entity_flush_dirty_stats();
+    turn_export(&turn_handoff);
+    turn_set_time_mode(TURN_TIME_FOLLOW);
+    rng_handoff = rng_get_state();
+    sim_run = run;
+    running = true;
+    if (pthread_create(&thread, NULL, sim_main, NULL) != 0) {
+        ui_cleanup();
+        fprintf(stderr, "FATAL: Could not start the simulation thread\n");
+        exit(1);
+    }
+}
+
+bool sim_running(void) {
+    return __atomic_load_n(&running, __ATOMIC_ACQUIRE);
+}
+
+void sim_join(void) {
+    pthread_join(thread, NULL);
+    turn_set_time_mode(TURN_TIME_OWN);
+    turn_import(&turn_handoff);
+    rng_set_state(rng_handoff);
+}
+
+// ----------------------------------------------------------------------------
+// Commands
+// ----------------------------------------------------------------------------
+
+bool sim_queue(const SimCommand* cmd) {
+    if (queue_staged - __atomic_load_n(&queue_tail, __ATOMIC_ACQUIRE) >= SIM_QUEUE_SIZE) return false;
+    queue[queue_staged & SIM_QUEUE_MASK] = *cmd;
+    queue_staged++;
+    return true;
+}
+
+void sim_submit(void) {
+    if (queue_staged == queue_head) return;
+    __atomic_store_n(&queue_head, queue_staged, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&doorbell_lock);
+    pthread_cond_signal(&doorbell);
+    pthread_mutex_unlock(&doorbell_lock);
+}
+
+int sim_pending(void) {
+    return (int)(__atomic_load_n(&queue_head, __ATOMIC_ACQUIRE) - queue_tail);
+}
+
+void sim_wait_command(SimCommand* out) {
+    if (__atomic_load_n(&queue_head, __ATOMIC_ACQUIRE) == queue_tail) {
+        pthread_mutex_lock(&doorbell_lock);
+        while (__atomic_load_n(&queue_head, __ATOMIC_ACQUIRE) == queue_tail) {
+            pthread_cond_wait(&doorbell, &doorbell_lock);
+        }
+        pthread_mutex_unlock(&doorbell_lock);
+    }
+    *out = queue[queue_tail & SIM_QUEUE_MASK];
+    __atomic_store_n(&queue_tail, queue_tail + 1, __ATOMIC_RELEASE);
+}
+
+void sim_drop_commands(void) {
+    uint32_t head = __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE);
+    if (head == queue_tail) return;
+    __atomic_store_n(&queue_tail, head, __ATOMIC_RELEASE);
+    drops++;
+}
+
+// ----------------------------------------------------------------------------
+// Real-time Clock
+// ----------------------------------------------------------------------------
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int64_t tick_due_ns(long tick) {
+    return clock_origin_ns + (int64_t)(tick - clock_origin_tick) * 1000000000LL / clock_rate;
+}
+
+void sim_set_realtime(int ticks_per_second) {
+    clock_rate = ticks_per_second > 0 ? ticks_per_second : 0;
+}
+
+int sim_realtime(void) {
+    return clock_rate;
+}
+
+void sim_clock_restart(void) {
+    clock_origin_tick = turn_get_current_time();
+    clock_origin_ns = clock_resumed_ns = now_ns();
+}
+
+long sim_clock_now(void) {
+    long tick = clock_origin_tick + (long)((now_ns() - clock_origin_ns) * clock_rate / 1000000000LL);
+    long time = turn_get_current_time();
+    return tick > time ? tick : time;
+}
+
+static void clock_record(int64_t lag) {
+    SimClockStats* st = &clock_stats;
+    st->events++;
+    if (lag * clock_rate > 1000000000LL) st->late++;
+    parse_hist_add(&st->lag_us, (int)(lag < INT32_MAX * 1000LL ? lag / 1000 : INT32_MAX));
+
+    if (lag > SIM_MAX_LAG_MS * 1000000LL) {
+        // Too far behind to catch up in a burst: let game time slip instead
+        clock_origin_ns += lag;
+        st->drift_ns += lag;
+        st->resyncs++;
+    }
+}
+
+bool sim_clock_wait(long tick, bool wake_on_command) {
+    int64_t start = now_ns();
+    clock_stats.busy_ns += start - clock_resumed_ns;
+
+    bool due = false;
+    pthread_mutex_lock(&doorbell_lock);
+    for (;;) {
+        if (wake_on_command && __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE) != queue_tail) break;
+        if (tick < 0) {
+            if (!wake_on_command) break; // Nothing could wake us
+            pthread_cond_wait(&doorbell, &doorbell_lock);
+            continue;
+        }
+
+        int64_t wait = tick_due_ns(tick) - now_ns();
+        if (wait <= 0) {
+            due = true;
+            break;
+        }
+        // The condition variable times out on CLOCK_REALTIME; only the
+        // interval is taken from it, so a clock step costs one early wakeup
+        struct timespec at;
+        clock_gettime(CLOCK_REALTIME, &at);
+        int64_t ns = at.tv_nsec + wait;
+        at.tv_sec += ns / 1000000000LL;
+        at.tv_nsec = ns % 1000000000LL;
+        pthread_cond_timedwait(&doorbell, &doorbell_lock, &at);
+    }
+    pthread_mutex_unlock(&doorbell_lock);
+
+    clock_resumed_ns = now_ns();
+    clock_stats.idle_ns += clock_resumed_ns - start;
+    if (due) clock_record(clock_resumed_ns - tick_due_ns(tick));
+    return due;
+}
+
+const SimClockStats* sim_clock_stats(void) {
+    return &clock_stats;
+}
+
+void sim_clock_reset_stats(void) {
+    memset(&clock_stats, 0, sizeof(clock_stats));
+    clock_resumed_ns = now_ns();
+}
+
+// ----------------------------------------------------------------------------
+// Snapshots
+// ----------------------------------------------------------------------------
+
+void sim_publish(Game* game, bool awaiting_input) {
+    WorldSnapshot* s = &snapshots[snap_back];
+    const MapView* v = &s->view;
+    ui_map_view_fill(&s->view, &game->current_map, &game->player);
+
+    s->player = game->player;
+    s->entity_count = 0;
+    for (int i = 0; i < game->entity_count; i++) {
+        const Entity* e = &game->entities[i];
+        if (e->x < v->x0 || e->x >= v->x1 || e->y < v->y0 || e->y >= v->y1) continue;
+        s->entities[s->entity_count++] = *e;
+    }
+    s->target = target_selected(game);
+    s->time = turn_get_current_time();
+
+    s->awaiting_input = awaiting_input;
+    s->commands_done = queue_tail;
+    s->drops = drops;
+    s->overviews = overviews;
+    s->seq = ++snap_seq;
+
+    snap_back = __atomic_exchange_n(&snap_middle, snap_back | SNAP_FRESH, __ATOMIC_ACQ_REL) & 3;
+}
+
+void sim_request_overview(void) {
+    overviews++;
+}
+
+const WorldSnapshot* sim_latest(void) {
+    if (__atomic_load_n(&snap_middle, __ATOMIC_ACQUIRE) & SNAP_FRESH) {
+        snap_front = __atomic_exchange_n(&snap_middle, snap_front, __ATOMIC_ACQ_REL) & 3;
+    }
+    const WorldSnapshot* s = &snapshots[snap_front];
+    return s->seq ? s : NULL;
+}
+
+bool sim_idle(const WorldSnapshot* s) {
+    return clock_rate == 0 && s && s->awaiting_input && s->commands_done == queue_head;
+}
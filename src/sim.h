@@ -0,0 +1,116 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "command.h"
+#include "game.h"
+#include "parse.h"
+#include "ui.h"
+
+// Simulation Thread
+// In the dungeon the scheduler runs on its own thread while the main thread
+// only draws and reads keys, so a slow terminal never holds up game time.
+// The threads share two things:
+//
+//   Commands (main -> simulation): a lock-free single-producer ring. The
+//   producer stages any number of commands and makes them visible at once
+//   with sim_submit, so a burst of keys arrives as one batch.
+//
+//   Snapshots (simulation -> main): immutable copies of what the screen
+//   shows (viewport tiles, minimap, entities in view, player), triple
+//   buffered so neither side ever waits for the other. The log is read
+//   straight from the evlog ring, whose records never change once published.
+//
+// The simulation thread takes over task worker 0, the scheduler and the RNG
+// stream while it runs (both are per-thread), and hands them back on exit.
+// Dirty entity stats, also queued per-thread, are flushed on either side.
+//
+// Real-time mode (--realtime N) paces the simulation thread to the wall
+// clock at N ticks a second: each event waits until it is due, so monsters
+// and auto-attacks go on while no key is pressed. The clock restarts from the
+// current game time whenever the thread starts, so time in the menu is free.
+// Falling more than SIM_MAX_LAG_MS behind moves the clock instead of
+// replaying the backlog in a burst; that slip is reported as drift.
+
+#define SIM_MAX_LAG_MS 250
+
+typedef enum {
+    SIM_CMD_MOVE,    // dx, dy
+    SIM_CMD_WAIT,
+    SIM_CMD_TARGET,  // arg: +1 next, -1 previous
+    SIM_CMD_MACRO,   // arg: F-key
+    SIM_CMD_LINE,    // text: slash command line
+    SIM_CMD_MENU,
+    SIM_CMD_QUIT
+} SimCommandType;
+
+typedef struct {
+    SimCommandType type;
+    int dx, dy;
+    int arg;
+    char text[COMMAND_LINE_LEN];
+} SimCommand;
+
+typedef struct {
+    uint64_t seq;            // 0 = nothing published yet
+
+    MapView view;
+    Entity player;
+    Entity entities[MAX_ENTITIES]; // Those in the viewport
+    int entity_count;
+    EntityID target;
+    long time;
+
+    bool awaiting_input;     // Simulation is blocked on the next command
+    uint32_t commands_done;  // Commands taken or dropped so far
+    uint32_t drops;          // Times queued commands were dropped
+    uint32_t overviews;      // /map requests so far
+} WorldSnapshot;
+
+typedef struct {
+    long events;             // Events fired on the clock
+    long late;               // Fired more than a tick after they were due
+    ParseHistogram lag_us;   // Wall-clock lateness per event
+    long resyncs;            // Times the clock was moved to catch up
+    int64_t drift_ns;        // Wall time lost to resyncs
+    int64_t busy_ns;         // Simulating...
+    int64_t idle_ns;         // ...and waiting for the clock or the player
+} SimClockStats;
+
+// Lifecycle (main thread)
+void sim_start(void (*run)(void)); // Runs run() on the simulation thread
+bool sim_running(void);            // False once run() has returned
+void sim_join(void);
+
+// Commands: main thread side
+bool sim_queue(const SimCommand* cmd); // Staged; false if the ring is full
+void sim_submit(void);                 // Publishes staged commands
+
+// Commands: simulation side
+int sim_pending(void);
+void sim_wait_command(SimCommand* out); // Blocks until one is submitted
+void sim_drop_commands(void);           // Run interrupted: discard the rest
+
+// Real-time clock
+void sim_set_realtime(int ticks_per_second); // 0: turn-based (the default)
+int sim_realtime(void);                      // Ticks per second, 0 if off
+
+// Clock: simulation side
+long sim_clock_now(void); // The tick due now, never before the game time
+void sim_clock_restart(void); // The game time is due now (thread start, load)
+// Waits until tick is due (true), or until a command is submitted if
+// wake_on_command (false). tick < 0 waits for a command only.
+bool sim_clock_wait(long tick, bool wake_on_command);
+const SimClockStats* sim_clock_stats(void);
+void sim_clock_reset_stats(void);
+
+// Snapshots: simulation side
+void sim_publish(Game* game, bool awaiting_input);
+void sim_request_overview(void);        // Shown by the main thread (/map)
+
+// Snapshots: main thread side
+const WorldSnapshot* sim_latest(void);  // NULL until the first publish
+bool sim_idle(const WorldSnapshot* s);  // Waiting on us, nothing in flight, no clock
+
+#endif
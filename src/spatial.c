@@ -0,0 +1,72 @@
+#include <string.h>
+#include <stdlib.h>
+#include "spatial.h"
+#include "game.h"
+
+// Head of each cell's chain: entity index + 1, 0 = empty
+static int cells[SPATIAL_CELLS_X * SPATIAL_CELLS_Y];
+
+static int cell_of(int x, int y) {
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x >= MAX_MAP_WIDTH) x = MAX_MAP_WIDTH - 1;
+    if (y >= MAX_MAP_HEIGHT) y = MAX_MAP_HEIGHT - 1;
+    return (y >> SPATIAL_CELL_SHIFT) * SPATIAL_CELLS_X + (x >> SPATIAL_CELL_SHIFT);
+}
+
+static int index_of(const Entity* e) {
+    return (int)(e - g_game.entities);
+}
+
+void spatial_reset(void) {
+    memset(cells, 0, sizeof(cells));
+}
+
+void spatial_insert(Entity* e) {
+    if (e->spatial_cell) return; // Already indexed
+    int cell = cell_of(e->x, e->y);
+    e->spatial_next = cells[cell];
+    e->spatial_cell = cell + 1;
+    cells[cell] = index_of(e) + 1;
+}
+
+void spatial_remove(Entity* e) {
+    if (!e->spatial_cell) return;
+
+    int me = index_of(e) + 1;
+    int* link = &cells[e->spatial_cell - 1];
+    while (*link && *link != me) link = &g_game.entities[*link - 1].spatial_next;
+    if (*link) *link = e->spatial_next;
+
+    e->spatial_cell = 0;
+    e->spatial_next = 0;
+}
+
+void spatial_update(Entity* e) {
+    if (!e->spatial_cell) return;
+    if (cell_of(e->x, e->y) + 1 == e->spatial_cell) return; // Same cell
+    spatial_remove(e);
+    spatial_insert(e);
+}
+
+int spatial_query(int x, int y, int radius, Entity** out, int max) {
+    int x0 = (x - radius) >> SPATIAL_CELL_SHIFT, x1 = (x + radius) >> SPATIAL_CELL_SHIFT;
+    int y0 = (y - radius) >> SPATIAL_CELL_SHIFT, y1 = (y + radius) >> SPATIAL_CELL_SHIFT;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= SPATIAL_CELLS_X) x1 = SPATIAL_CELLS_X - 1;
+    if (y1 >= SPATIAL_CELLS_Y) y1 = SPATIAL_CELLS_Y - 1;
+
+    int count = 0;
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            for (int i = cells[cy * SPATIAL_CELLS_X + cx]; i; i = g_game.entities[i - 1].spatial_next) {
+                Entity* e = &g_game.entities[i - 1];
+                if (abs(e->x - x) > radius || abs(e->y - y) > radius) continue;
+                if (count >= max) return count;
+                out[count++] = e;
+            }
+        }
+    }
+    return count;
+}
@@ -0,0 +1,25 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include "entity.h"
+#include "map.h"
+
+// Spatial Grid
+// Buckets the zone's monsters into 8x8 tile cells so range queries only look
+// at nearby cells. Entities are chained through Entity.spatial_next; the grid
+// covers g_game.entities.
+
+#define SPATIAL_CELL_SHIFT 3
+#define SPATIAL_CELLS_X (MAX_MAP_WIDTH >> SPATIAL_CELL_SHIFT)
+#define SPATIAL_CELLS_Y (MAX_MAP_HEIGHT >> SPATIAL_CELL_SHIFT)
+
+void spatial_reset(void);
+void spatial_insert(Entity* e);
+void spatial_remove(Entity* e);
+void spatial_update(Entity* e); // Call after e->x / e->y change
+
+// Collects indexed entities within Chebyshev distance radius of (x, y).
+// Returns how many were written to out (at most max).
+int spatial_query(int x, int y, int radius, Entity** out, int max);
+
+#endif
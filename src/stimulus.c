@@ -0,0 +1,62 @@
+#include <stdlib.h>
+#include "stimulus.h"
+#include "spatial.h"
+#include "ai.h"
+
+#define MAX_LISTENERS 64
+
+// Default ranges:                    SIGHT SOUND SMELL MAGIC
+static const int STIM_RANGES[STIM_MAX][STIM_SENSES] = {
+    [STIM_FOOTSTEP] =               {  8,    5,    3,    0 },
+    [STIM_COMBAT]   =               {  8,    8,    0,    0 },
+    [STIM_SPELL]    =               {  8,    6,    0,   10 },
+};
+
+void stimulus_emit(Game* game, StimulusType type, int x, int y, int intensity, EntityID source_id) {
+    Stimulus s;
+    s.type = type;
+    s.x = x;
+    s.y = y;
+    s.source_id = source_id;
+    for (int i = 0; i < STIM_SENSES; i++) s.range[i] = STIM_RANGES[type][i] * intensity / 100;
+    stimulus_broadcast(game, &s);
+}
+
+// Which of the listener's senses pick the stimulus up
+static uint8_t perceive(Game* game, const Stimulus* s, const Entity* mob) {
+    int d = abs(mob->x - s->x);
+    if (abs(mob->y - s->y) > d) d = abs(mob->y - s->y);
+
+    uint8_t sensed = 0;
+    int los = -1; // Computed on demand
+    for (int sense = 0; sense < STIM_SENSES; sense++) {
+        uint8_t flag = (uint8_t)(1 << sense);
+        if (!(mob->detection_flags & flag) || d > s->range[sense]) continue;
+
+        if (flag == DETECT_SIGHT || flag == DETECT_SOUND) {
+            if (los < 0) los = map_line_of_sight(&game->current_map, mob->x, mob->y, s->x, s->y);
+            if (flag == DETECT_SIGHT && !los) continue;
+            if (flag == DETECT_SOUND && !los && d > s->range[sense] / 2) continue; // Muffled by walls
+        }
+        sensed |= flag;
+    }
+    return sensed;
+}
+
+void stimulus_broadcast(Game* game, const Stimulus* s) {
+    int radius = 0;
+    for (int i = 0; i < STIM_SENSES; i++) {
+        if (s->range[i] > radius) radius = s->range[i];
+    }
+    if (radius <= 0) return;
+
+    Entity* listeners[MAX_LISTENERS];
+    int count = spatial_query(s->x, s->y, radius, listeners, MAX_LISTENERS);
+    for (int i = 0; i < count; i++) {
+        Entity* mob = listeners[i];
+        if (!mob->is_active || mob->id == s->source_id || mob->detection_flags == 0) continue;
+
+        uint8_t sensed = perceive(game, s, mob);
+        if (sensed) ai_on_stimulus(mob, s, sensed, game);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef STIMULUS_H
+#define STIMULUS_H
+
+#include "entity.h"
+#include "game.h"
+
+// Sensory Stimuli
+// Actions broadcast a stimulus (what, where, how loud). The spatial grid finds
+// the monsters in range and only those with a matching DETECT_* flag hear,
+// see or smell it. Aggro costs scale with stimuli and nearby listeners
+// instead of every monster polling the sense layers every turn.
+
+typedef enum {
+    STIM_FOOTSTEP,  // Someone moved
+    STIM_COMBAT,    // A swing landed or missed
+    STIM_SPELL,     // Spellcasting
+    STIM_MAX
+} StimulusType;
+
+// Per-sense ranges, indexed by sense bit (SIGHT, SOUND, SMELL, MAGIC)
+#define STIM_SENSES 4
+
+typedef struct {
+    StimulusType type;
+    int x, y;
+    EntityID source_id;
+    int range[STIM_SENSES]; // Tiles; 0 = not perceivable by that sense
+} Stimulus;
+
+// Broadcasts a stimulus with the default ranges for its type scaled by
+// intensity (100 = normal).
+void stimulus_emit(Game* game, StimulusType type, int x, int y, int intensity, EntityID source_id);
+void stimulus_broadcast(Game* game, const Stimulus* s);
+
+#endif
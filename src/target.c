@@ -0,0 +1,89 @@
+#include "target.h"
+#include "spatial.h"
+
+static EntityID selected = -1;
+
+static bool in_view(Game* game, const Entity* e) {
+    if (!e || !e->is_active || e->is_burrowed || e->type != ENTITY_ENEMY) return false;
+    return game->current_map.tiles[e->x][e->y].visible;
+}
+
+static int distance_sq(const Entity* a, const Entity* b) {
+    int dx = a->x - b->x, dy = a->y - b->y;
+    return dx * dx + dy * dy;
+}
+
+int target_visible(Game* game, const Entity* player, Entity** out, int max) {
+    Entity* near[MAX_ENTITIES];
+    int n = spatial_query(player->x, player->y, FOV_RADIUS, near, MAX_ENTITIES);
+
+    // Insertion sort: only what the player can see, a handful at most
+    int count = 0;
+    int dist[MAX_ENTITIES];
+    for (int i = 0; i < n; i++) {
+        Entity* e = near[i];
+        if (!in_view(game, e)) continue;
+
+        int d = distance_sq(e, player);
+        int j = count++;
+        while (j > 0 && (dist[j - 1] > d || (dist[j - 1] == d && near[j - 1]->id > e->id))) {
+            dist[j] = dist[j - 1];
+            near[j] = near[j - 1];
+            j--;
+        }
+        dist[j] = d;
+        near[j] = e;
+    }
+
+    if (count > max) count = max;
+    for (int i = 0; i < count; i++) out[i] = near[i];
+    return count;
+}
+
+EntityID target_nearest(Game* game, const Entity* player) {
+    Entity* list[1];
+    return target_visible(game, player, list, 1) > 0 ? list[0]->id : -1;
+}
+
+EntityID target_cycle(Game* game, const Entity* player, int dir) {
+    Entity* list[TARGET_MAX];
+    int count = target_visible(game, player, list, TARGET_MAX);
+    if (count == 0) {
+        selected = -1;
+        return -1;
+    }
+
+    int at = -1;
+    for (int i = 0; i < count; i++) {
+        if (list[i]->id == selected) at = i;
+    }
+    if (at < 0) at = 0;
+    else at = (at + (dir < 0 ? count - 1 : 1)) % count;
+
+    selected = list[at]->id;
+    return selected;
+}
+
+EntityID target_selected(Game* game) {
+    if (selected >= 0 && !in_view(game, game_get_entity(selected))) selected = -1;
+    return selected;
+}
+
+void target_select(EntityID id) {
+    selected = id;
+}
+
+void target_clear(void) {
+    selected = -1;
+}
+
+EntityID target_battle(Game* game, const Entity* player) {
+    if (player->is_engaged && in_view(game, game_get_entity(player->target_id))) return player->target_id;
+
+    Entity* list[TARGET_MAX];
+    int count = target_visible(game, player, list, TARGET_MAX);
+    for (int i = 0; i < count; i++) {
+        if (list[i]->is_engaged && list[i]->target_id == player->id) return list[i]->id;
+    }
+    return -1;
+}
@@ -0,0 +1,35 @@
+#ifndef TARGET_H
+#define TARGET_H
+
+#include "entity.h"
+#include "game.h"
+
+// Targeting
+// Candidates come from a spatial grid query of FOV_RADIUS around the player,
+// kept only if they stand on a tile lit by the last FOV, so the cost depends
+// on the monsters nearby, not on how many are in the zone. Lists are ordered
+// nearest first (ties by id, so cycling is stable).
+//
+// The selected target is what Tab picks and <t> names; it is dropped once it
+// dies, burrows or leaves view.
+
+#define TARGET_MAX 64
+
+// Visible enemies, nearest first; returns how many were written (at most max)
+int target_visible(Game* game, const Entity* player, Entity** out, int max);
+
+EntityID target_nearest(Game* game, const Entity* player); // -1 if none in view
+
+// Tab / Shift+Tab: the next farther (dir > 0) or nearer (dir < 0) enemy after
+// the selection, wrapping; the nearest if nothing is selected
+EntityID target_cycle(Game* game, const Entity* player, int dir);
+
+EntityID target_selected(Game* game);  // -1 if none, or no longer in view
+void target_select(EntityID id);
+void target_clear(void);               // Zoning: ids are reused
+
+// <bt>: the monster the player is fighting, else the nearest visible one
+// fighting the player
+EntityID target_battle(Game* game, const Entity* player);
+
+#endif
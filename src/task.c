@@ -0,0 +1,254 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <string.h>
+#include "task.h"
+
+#define DEQUE_SIZE 256 // Per worker, power of two
+#define DEQUE_MASK (DEQUE_SIZE - 1)
+
+typedef struct {
+    TaskFn fn;
+    void* arg;
+    int begin, end;
+    int* counter;       // Decremented when the task finishes
+    TaskGraph* graph;   // Graph node tasks: release dependents when done
+    int node;
+} Task;
+
+// Owner pushes/pops at bottom, thieves take from top
+typedef struct {
+    pthread_mutex_t lock;
+    Task tasks[DEQUE_SIZE];
+    int top, bottom;
+} Deque;
+
+static Deque deques[TASK_MAX_WORKERS];
+static pthread_t threads[TASK_MAX_WORKERS];
+static int worker_count = 1;
+static bool running = false;
+static __thread int worker_id = 0; // The thread that called task_init is worker 0
+
+// Idle workers sleep until something is queued
+static pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+static int queued = 0; // Tasks sitting in any deque
+
+// ----------------------------------------------------------------------------
+// Deques
+// ----------------------------------------------------------------------------
+
+static void run_task(Task* t);
+
+static void wake_workers(void) {
+    pthread_mutex_lock(&idle_lock);
+    pthread_cond_broadcast(&idle_cond);
+    pthread_mutex_unlock(&idle_lock);
+}
+
+static void push_task(Task t) {
+    Deque* d = &deques[worker_id];
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom - d->top >= DEQUE_SIZE) {
+        pthread_mutex_unlock(&d->lock);
+        run_task(&t); // Full: do it now
+        return;
+    }
+    d->tasks[d->bottom & DEQUE_MASK] = t;
+    d->bottom++;
+    __atomic_add_fetch(&queued, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&d->lock);
+}
+
+static bool pop_task(Deque* d, Task* out) {
+    bool found = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) {
+        d->bottom--;
+        *out = d->tasks[d->bottom & DEQUE_MASK];
+        found = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+static bool steal_task(Deque* d, Task* out) {
+    bool found = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) {
+        *out = d->tasks[d->top & DEQUE_MASK];
+        d->top++;
+        found = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+static bool find_task(Task* out) {
+    if (pop_task(&deques[worker_id], out)) goto found;
+    for (int i = 1; i < worker_count; i++) {
+        if (steal_task(&deques[(worker_id + i) % worker_count], out)) goto found;
+    }
+    return false;
+
+found:
+    __atomic_sub_fetch(&queued, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void graph_node_done(TaskGraph* g, int node);
+
+static void run_task(Task* t) {
+    t->fn(t->arg, t->begin, t->end);
+    if (t->graph) graph_node_done(t->graph, t->node);
+    if (t->counter) __atomic_sub_fetch(t->counter, 1, __ATOMIC_RELEASE);
+}
+
+// Helps with queued work until *counter drops to zero
+static void wait_for(int* counter) {
+    while (__atomic_load_n(counter, __ATOMIC_ACQUIRE) > 0) {
+        Task t;
+        if (find_task(&t)) run_task(&t);
+        else sched_yield(); // Remaining tasks are running elsewhere
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Workers
+// ----------------------------------------------------------------------------
+
+static void* worker_main(void* arg) {
+    worker_id = (int)(long)arg;
+
+    while (__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        Task t;
+        if (find_task(&t)) {
+            run_task(&t);
+            continue;
+        }
+        pthread_mutex_lock(&idle_lock);
+        while (__atomic_load_n(&queued, __ATOMIC_ACQUIRE) == 0 && __atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+            pthread_cond_wait(&idle_cond, &idle_lock);
+        }
+        pthread_mutex_unlock(&idle_lock);
+    }
+    return NULL;
+}
+
+void task_init(int workers) {
+    if (workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers < 1) workers = 1;
+    if (workers > TASK_MAX_WORKERS) workers = TASK_MAX_WORKERS;
+
+    worker_count = workers;
+    for (int i = 0; i < worker_count; i++) {
+        pthread_mutex_init(&deques[i].lock, NULL);
+        deques[i].top = deques[i].bottom = 0;
+    }
+
+    running = true;
+    for (int i = 1; i < worker_count; i++) {
+        if (pthread_create(&threads[i], NULL, worker_main, (void*)(long)i) != 0) {
+            worker_count = i; // Run with what we got
+            break;
+        }
+    }
+}
+
+void task_shutdown(void) {
+    if (!running) return;
+
+    pthread_mutex_lock(&idle_lock);
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&idle_cond);
+    pthread_mutex_unlock(&idle_lock);
+
+    for (int i = 1; i < worker_count; i++) pthread_join(threads[i], NULL);
+    for (int i = 0; i < worker_count; i++) pthread_mutex_destroy(&deques[i].lock);
+    worker_count = 1;
+}
+
+int task_worker_count(void) {
+    return worker_count;
+}
+
+// ----------------------------------------------------------------------------
+// Parallel For
+// ----------------------------------------------------------------------------
+
+void parallel_for(int begin, int end, int grain, TaskFn fn, void* arg) {
+    if (end <= begin) return;
+    if (grain < 1) grain = 1;
+
+    // Single thread fallback, or not worth splitting
+    if (worker_count == 1 || end - begin <= grain) {
+        fn(arg, begin, end);
+        return;
+    }
+
+    int bands = (end - begin + grain - 1) / grain;
+    int counter = bands;
+    for (int b = begin; b < end; b += grain) {
+        Task t = {fn, arg, b, b + grain < end ? b + grain : end, &counter, NULL, 0};
+        push_task(t);
+    }
+    wake_workers();
+    wait_for(&counter);
+}
+
+// ----------------------------------------------------------------------------
+// Task Graphs
+// ----------------------------------------------------------------------------
+
+void task_graph_init(TaskGraph* g) {
+    memset(g, 0, sizeof(TaskGraph));
+}
+
+int task_graph_add(TaskGraph* g, TaskFn fn, void* arg) {
+    if (g->node_count >= TASK_GRAPH_MAX_NODES) return -1;
+    TaskNode* n = &g->nodes[g->node_count];
+    memset(n, 0, sizeof(TaskNode));
+    n->fn = fn;
+    n->arg = arg;
+    return g->node_count++;
+}
+
+bool task_graph_depend(TaskGraph* g, int node, int on) {
+    if (node < 0 || on < 0 || node >= g->node_count || on >= g->node_count || node == on) return false;
+    TaskNode* parent = &g->nodes[on];
+    if (parent->dependent_count >= TASK_GRAPH_MAX_DEPENDENTS) return false;
+    parent->dependents[parent->dependent_count++] = node;
+    g->nodes[node].dep_count++;
+    return true;
+}
+
+static void push_node(TaskGraph* g, int node) {
+    Task t = {g->nodes[node].fn, g->nodes[node].arg, 0, 1, &g->pending, g, node};
+    push_task(t);
+}
+
+static void graph_node_done(TaskGraph* g, int node) {
+    TaskNode* n = &g->nodes[node];
+    bool released = false;
+    for (int i = 0; i < n->dependent_count; i++) {
+        int d = n->dependents[i];
+        if (__atomic_sub_fetch(&g->nodes[d].remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+            push_node(g, d);
+            released = true;
+        }
+    }
+    if (released) wake_workers();
+}
+
+void task_graph_run(TaskGraph* g) {
+    if (g->node_count == 0) return;
+
+    g->pending = g->node_count;
+    for (int i = 0; i < g->node_count; i++) g->nodes[i].remaining = g->nodes[i].dep_count;
+    for (int i = 0; i < g->node_count; i++) {
+        if (g->nodes[i].dep_count == 0) push_node(g, i);
+    }
+    wake_workers();
+    wait_for(&g->pending);
+}
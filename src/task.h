@@ -0,0 +1,50 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <stdbool.h>
+
+// Work-Stealing Task Pool
+// Each worker owns a deque: it pushes and pops at the bottom while idle
+// workers steal from the top. Threads that wait on work (parallel_for,
+// task_graph_run) run queued tasks instead of blocking, so waits can nest.
+// With one worker everything runs inline on the calling thread.
+
+#define TASK_MAX_WORKERS 16
+
+// Body for a band [begin, end)
+typedef void (*TaskFn)(void* arg, int begin, int end);
+
+void task_init(int workers); // 0 = one per core
+void task_shutdown(void);
+int task_worker_count(void);
+
+// Splits [begin, end) into bands of `grain` items and runs them on the pool.
+// Returns when every band has finished.
+void parallel_for(int begin, int end, int grain, TaskFn fn, void* arg);
+
+// Task Graphs
+// Nodes run once all the nodes they depend on have finished.
+#define TASK_GRAPH_MAX_NODES 32
+#define TASK_GRAPH_MAX_DEPENDENTS 8
+
+typedef struct {
+    TaskFn fn;
+    void* arg;
+    int dependents[TASK_GRAPH_MAX_DEPENDENTS];
+    int dependent_count;
+    int dep_count;   // Static: number of nodes this one waits for
+    int remaining;   // Runtime: dependencies not yet finished
+} TaskNode;
+
+typedef struct {
+    TaskNode nodes[TASK_GRAPH_MAX_NODES];
+    int node_count;
+    int pending;     // Runtime: nodes not yet finished
+} TaskGraph;
+
+void task_graph_init(TaskGraph* g);
+int task_graph_add(TaskGraph* g, TaskFn fn, void* arg); // fn is called with (arg, 0, 1)
+bool task_graph_depend(TaskGraph* g, int node, int on);  // node runs after `on`
+void task_graph_run(TaskGraph* g);                       // Returns when all nodes finished
+
+#endif
@@ -0,0 +1,298 @@
+#define _POSIX_C_SOURCE 200809L
+#include <ncurses.h> // KEY_* codes only; the ANSI backend never starts curses
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "term.h"
+
+#define OUT_CAPACITY 65536
+#define ESC_WAIT_MS 25 // Same as ESCDELAY under curses
+
+static char out[OUT_CAPACITY];
+static int out_len = 0;
+
+static int out_fd = STDOUT_FILENO;
+static struct termios saved_termios;
+static bool is_open = false;
+static bool is_raw = false; // termios changed, restore on close
+
+// What the terminal currently has, so redundant moves and SGRs are skipped.
+// -1 = unknown.
+static int at_x = -1, at_y = -1;
+static int sgr_attr = -1, sgr_pair = -1;
+static int cursor_visible = -1;
+
+// Foreground per colour pair, mirroring the init_pair table in ui.c. All
+// pairs draw on black. Entries are SGR parameter strings.
+static const char* PAIR_FG[16] = {
+    "37", "33", "37", "31", "36", "34", "36", "37",
+    "37", "37", "34", "36", "37", "38;5;130", "35", "37"
+};
+
+// ----------------------------------------------------------------------------
+// Output
+// ----------------------------------------------------------------------------
+
+static void write_all(const char* buf, int len) {
+    while (len > 0) {
+        ssize_t n = write(out_fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return; // Terminal gone; nothing useful to do
+        }
+        buf += n;
+        len -= n;
+    }
+}
+
+void term_flush(void) {
+    if (out_len == 0) return;
+    write_all(out, out_len);
+    out_len = 0;
+}
+
+static void emit(const char* s, int len) {
+    if (out_len + len > OUT_CAPACITY) term_flush(); // Oversized frame: two writes
+    memcpy(out + out_len, s, len);
+    out_len += len;
+}
+
+static void emit_str(const char* s) {
+    emit(s, (int)strlen(s));
+}
+
+static void emit_int(int v) {
+    char buf[12];
+    int n = 0;
+    do {
+        buf[sizeof(buf) - 1 - n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    emit(buf + sizeof(buf) - n, n);
+}
+
+static void emit_utf8(uint32_t ch) {
+    char buf[4];
+    int n;
+    if (ch < 0x80) {
+        buf[0] = (char)ch;
+        n = 1;
+    } else if (ch < 0x800) {
+        buf[0] = (char)(0xC0 | (ch >> 6));
+        buf[1] = (char)(0x80 | (ch & 0x3F));
+        n = 2;
+    } else if (ch < 0x10000) {
+        buf[0] = (char)(0xE0 | (ch >> 12));
+        buf[1] = (char)(0x80 | ((ch >> 6) & 0x3F));
+        buf[2] = (char)(0x80 | (ch & 0x3F));
+        n = 3;
+    } else {
+        buf[0] = (char)(0xF0 | (ch >> 18));
+        buf[1] = (char)(0x80 | ((ch >> 12) & 0x3F));
+        buf[2] = (char)(0x80 | ((ch >> 6) & 0x3F));
+        buf[3] = (char)(0x80 | (ch & 0x3F));
+        n = 4;
+    }
+    emit(buf, n);
+}
+
+static void move_to(int x, int y) {
+    if (x == at_x && y == at_y) return;
+
+    if (y == at_y && x > at_x && at_x >= 0) {
+        emit_str("\x1b[");            // Same row, forward: CUF is shorter
+        if (x - at_x > 1) emit_int(x - at_x);
+        emit_str("C");
+    } else {
+        emit_str("\x1b[");
+        emit_int(y + 1);
+        emit_str(";");
+        emit_int(x + 1);
+        emit_str("H");
+    }
+    at_x = x;
+    at_y = y;
+}
+
+static void set_sgr(uint8_t attr, uint8_t pair) {
+    if (attr == sgr_attr && pair == sgr_pair) return;
+
+    emit_str("\x1b[0");
+    if (attr & TERM_ATTR_BOLD) emit_str(";1");
+    if (attr & TERM_ATTR_DIM) emit_str(";2");
+    if (attr & TERM_ATTR_REVERSE) emit_str(";7");
+    emit_str(";");
+    emit_str(PAIR_FG[pair & 15]);
+    emit_str(";40m");
+    sgr_attr = attr;
+    sgr_pair = pair;
+}
+
+void term_cell(int x, int y, uint32_t ch, uint8_t attr, uint8_t pair) {
+    move_to(x, y);
+    set_sgr(attr, pair);
+    emit_utf8(ch);
+    at_x++; // Past the last column the position is terminal-specific
+}
+
+void term_cursor(int x, int y, bool visible) {
+    if (visible) move_to(x, y);
+    if (cursor_visible != (int)visible) {
+        emit_str(visible ? "\x1b[?25h" : "\x1b[?25l");
+        cursor_visible = visible;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Setup
+// ----------------------------------------------------------------------------
+
+static void restore_on_signal(int sig) {
+    term_close();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+bool term_open(void) {
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) return false;
+    if (tcgetattr(STDIN_FILENO, &saved_termios) != 0) return false;
+
+    // Like curses cbreak + noecho: keys arrive at once, ^C still works
+    struct termios raw = saved_termios;
+    raw.c_lflag &= ~(ICANON | ECHO | IEXTEN);
+    raw.c_iflag &= ~(IXON | ICRNL);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) return false;
+
+    is_raw = true;
+    signal(SIGINT, restore_on_signal);
+    signal(SIGTERM, restore_on_signal);
+    term_open_headless(STDOUT_FILENO);
+    return true;
+}
+
+void term_open_headless(int fd) {
+    out_fd = fd;
+    is_open = true;
+    out_len = 0;
+    at_x = at_y = -1;
+    sgr_attr = sgr_pair = -1;
+    cursor_visible = -1;
+
+    emit_str("\x1b[?1049h\x1b[0;37;40m\x1b[2J"); // Alternate screen, black
+    term_cursor(0, 0, false);
+    term_flush();
+}
+
+void term_close(void) {
+    if (!is_open) return;
+    is_open = false;
+
+    out_len = 0;
+    emit_str("\x1b[0m\x1b[?25h\x1b[?1049l");
+    term_flush();
+    if (is_raw) {
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_termios);
+        is_raw = false;
+    }
+    out_fd = STDOUT_FILENO;
+}
+
+// ----------------------------------------------------------------------------
+// Input
+// ----------------------------------------------------------------------------
+
+static int read_byte(int timeout_ms) {
+    struct pollfd p = {STDIN_FILENO, POLLIN, 0};
+    for (;;) {
+        int r = poll(&p, 1, timeout_ms);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return ERR;
+
+        unsigned char c;
+        ssize_t n = read(STDIN_FILENO, &c, 1);
+        if (n < 0 && errno == EINTR) continue;
+        return n == 1 ? c : ERR;
+    }
+}
+
+// "\x1b[15~" style keys, by number
+static int tilde_key(int n) {
+    switch (n) {
+        case 15: return KEY_F(5);
+        case 17: return KEY_F(6);
+        case 18: return KEY_F(7);
+        case 19: return KEY_F(8);
+        case 20: return KEY_F(9);
+        case 21: return KEY_F(10);
+        case 23: return KEY_F(11);
+        case 24: return KEY_F(12);
+        case 3: return KEY_DC;
+        case 5: return KEY_PPAGE;
+        case 6: return KEY_NPAGE;
+        default: return ERR;
+    }
+}
+
+static int final_key(int c) {
+    switch (c) {
+        case 'A': return KEY_UP;
+        case 'B': return KEY_DOWN;
+        case 'C': return KEY_RIGHT;
+        case 'D': return KEY_LEFT;
+        case 'H': return KEY_HOME;
+        case 'F': return KEY_END;
+        case 'P': return KEY_F(1);
+        case 'Q': return KEY_F(2);
+        case 'R': return KEY_F(3);
+        case 'S': return KEY_F(4);
+        case 'Z': return KEY_BTAB;
+        default: return ERR;
+    }
+}
+
+// After ESC: a lone ESC, or a CSI / SS3 sequence
+static int read_escape(void) {
+    int c = read_byte(ESC_WAIT_MS);
+    if (c == ERR) return 27;
+    if (c == 'O') {
+        c = read_byte(ESC_WAIT_MS);
+        return c == ERR ? 27 : final_key(c);
+    }
+    if (c != '[') return 27; // Alt+key: treat as ESC
+
+    int n = 0;
+    for (;;) {
+        c = read_byte(ESC_WAIT_MS);
+        if (c == ERR) return 27;
+        if (c >= '0' && c <= '9') {
+            n = n * 10 + (c - '0');
+        } else if (c == ';') {
+            n = 0; // Modifier parameters are ignored
+        } else if (c == '~') {
+            return tilde_key(n);
+        } else {
+            return final_key(c);
+        }
+    }
+}
+
+int term_read_key(int timeout_ms) {
+    term_flush(); // Anything drawn is visible before we wait
+
+    for (;;) {
+        int c = read_byte(timeout_ms);
+        if (c == ERR) return ERR;
+        if (c == 27) {
+            int key = read_escape();
+            if (key == ERR) continue; // Unknown sequence: swallow it
+            return key;
+        }
+        if (c == 127 || c == 8) return KEY_BACKSPACE;
+        return c;
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef TERM_H
+#define TERM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Raw ANSI Terminal
+// The --ansi backend for ui.c: no curses. Cells are encoded as VT escape
+// sequences into one buffer, moving the cursor only on discontinuities and
+// changing SGR only when attributes change, and each frame goes out with a
+// single write().
+
+// Cell attributes (ui.c uses the same bits)
+#define TERM_ATTR_BOLD    1
+#define TERM_ATTR_DIM     2
+#define TERM_ATTR_REVERSE 4
+
+bool term_open(void);  // Raw mode + alternate screen; false if not a tty
+void term_open_headless(int fd); // Output only, to fd (benchmarks)
+void term_close(void);
+
+// Output (buffered until term_flush)
+void term_cell(int x, int y, uint32_t ch, uint8_t attr, uint8_t pair);
+void term_cursor(int x, int y, bool visible);
+void term_flush(void);
+
+// Input: a character or an ncurses KEY_* code, ERR on timeout (-1 blocks)
+int term_read_key(int timeout_ms);
+
+#endif
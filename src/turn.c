@@ -1,18 +1,85 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "turn.h"
 
-#define MAX_EVENTS 1024
 
-static GameEvent heap[MAX_EVENTS];
-static int heap_size = 0;
-static long global_time = 0;
-static long next_priority_id = 0;
+#define EVENT_SLOT_BITS 10 // 1 << EVENT_SLOT_BITS == TURN_MAX_EVENTS
+#define MAX_EVENTS TURN_MAX_EVENTS
+#define EVENT_SLOT_MASK (MAX_EVENTS - 1)
+#define EVENT_GEN_MASK 0xFFFFF // Keeps handles positive
+
+// Scheduler state is per-thread so headless tools can run one simulation per
+// thread with the same code. The game hands its copy to the simulation thread
+// (turn_export / turn_import).
+static __thread GameEvent heap[MAX_EVENTS];
+static __thread int heap_size = 0;
+static __thread long global_time = 0;
+static __thread long next_priority_id = 0;
+
+// Handle slots
+// Every queued event owns a slot. The slot tracks where the event currently sits
+// in the heap so it can be rescheduled or cancelled in O(log n).
+// The generation counter invalidates handles once their event is gone.
+static __thread int slot_heap_index[MAX_EVENTS];
+static __thread int slot_gen[MAX_EVENTS];
+static __thread int free_slots[MAX_EVENTS];
+static __thread int free_count = 0;
+
+// Shared clock
+// A thread that handed its scheduler over (TURN_TIME_FOLLOW) reads the time
+// the new owner publishes, so what it logs is stamped with the game's time.
+static long shared_time = 0;
+static __thread TurnTimeMode time_mode = TURN_TIME_OWN;
+
+static void set_time(long time) {
+    global_time = time;
+    if (time_mode == TURN_TIME_PUBLISH) __atomic_store_n(&shared_time, time, __ATOMIC_RELAXED);
+}
+
+void turn_set_time_mode(TurnTimeMode mode) {
+    // Whoever starts following was the owner: its time is current until then
+    if (mode != TURN_TIME_OWN) __atomic_store_n(&shared_time, global_time, __ATOMIC_RELAXED);
+    time_mode = mode;
+}
+
+static void reset_slots(void) {
+    free_count = 0;
+    for (int i = MAX_EVENTS - 1; i >= 0; i--) {
+        // Generation 0 is never handed out, so zeroed handles are always stale
+        slot_gen[i] = ((slot_gen[i] + 1) & EVENT_GEN_MASK);
+        if (slot_gen[i] == 0) slot_gen[i] = 1;
+        slot_heap_index[i] = -1;
+        free_slots[free_count++] = i;
+    }
+}
+
+static EventHandle make_handle(int slot) {
+    return (EventHandle)((slot_gen[slot] << EVENT_SLOT_BITS) | slot);
+}
+
+// Returns the slot for a live handle, or -1
+static int resolve_handle(EventHandle handle) {
+    if (handle <= 0) return -1;
+    int slot = handle & EVENT_SLOT_MASK;
+    int gen = (handle >> EVENT_SLOT_BITS) & EVENT_GEN_MASK;
+    if (slot_gen[slot] != gen) return -1;
+    if (slot_heap_index[slot] < 0) return -1;
+    return slot;
+}
+
+static void release_slot(int slot) {
+    slot_heap_index[slot] = -1;
+    slot_gen[slot] = (slot_gen[slot] + 1) & EVENT_GEN_MASK;
+    if (slot_gen[slot] == 0) slot_gen[slot] = 1;
+    free_slots[free_count++] = slot;
+}
 
 void turn_init(void) {
     heap_size = 0;
-    global_time = 0;
+    set_time(0);
     next_priority_id = 0;
+    reset_slots();
 }
 
 // Min-heap helpers
@@ -20,6 +87,8 @@ static void swap(int i, int j) {
     GameEvent temp = heap[i];
     heap[i] = heap[j];
     heap[j] = temp;
+    slot_heap_index[heap[i].slot] = i;
+    slot_heap_index[heap[j].slot] = j;
 }
 
 static int compare(GameEvent a, GameEvent b) {
@@ -30,7 +99,7 @@ static int compare(GameEvent a, GameEvent b) {
     return (a.priority_id < b.priority_id) ? -1 : 1;
 }
 
-static void sift_up(int idx) {
+static int sift_up(int idx) {
     while (idx > 0) {
         int parent = (idx - 1) / 2;
         if (compare(heap[idx], heap[parent]) < 0) {
@@ -40,6 +109,7 @@ static void sift_up(int idx) {
             break;
         }
     }
+    return idx;
 }
 
 static void sift_down(int idx) {
@@ -60,18 +130,45 @@ static void sift_down(int idx) {
     }
 }
 
-void turn_add_event(long time, EntityID entity_id, EventType type) {
-    if (heap_size >= MAX_EVENTS) return; // Error handling needed?
+// Removes the event at heap index idx, keeping the heap ordered
+static void remove_at(int idx) {
+    heap_size--;
+    if (idx == heap_size) return;
+
+    heap[idx] = heap[heap_size];
+    slot_heap_index[heap[idx].slot] = idx;
+    if (sift_up(idx) == idx) {
+        sift_down(idx);
+    }
+}
+
+EventHandle turn_add_event_data(long time, EntityID entity_id, EventType type, int data) {
+    if (heap_size >= MAX_EVENTS || free_count == 0) {
+        // Sized so this cannot happen (see TURN_MAX_EVENTS); a dropped event would stall its entity
+        fprintf(stderr, "FATAL: Turn queue full (%d events)\n", MAX_EVENTS);
+        exit(1);
+    }
+
+    int slot = free_slots[--free_count];
 
     GameEvent evt;
     evt.time = time;
     evt.entity_id = entity_id;
     evt.type = type;
+    evt.data = data;
     evt.priority_id = next_priority_id++;
+    evt.slot = slot;
 
     heap[heap_size] = evt;
-    sift_up(heap_size);
+    slot_heap_index[slot] = heap_size;
     heap_size++;
+    sift_up(heap_size - 1);
+
+    return make_handle(slot);
+}
+
+EventHandle turn_add_event(long time, EntityID entity_id, EventType type) {
+    return turn_add_event_data(time, entity_id, type, 0);
 }
 
 GameEvent turn_pop_event(void) {
@@ -81,11 +178,10 @@ GameEvent turn_pop_event(void) {
     }
 
     GameEvent root = heap[0];
-    global_time = root.time; // Update global time to current event
+    set_time(root.time); // Update global time to current event
 
-    heap[0] = heap[heap_size - 1];
-    heap_size--;
-    sift_down(0);
+    remove_at(0);
+    release_slot(root.slot);
 
     return root;
 }
@@ -94,10 +190,95 @@ bool turn_queue_is_empty(void) {
     return heap_size == 0;
 }
 
+long turn_next_time(void) {
+    return heap_size > 0 ? heap[0].time : -1;
+}
+
 long turn_get_current_time(void) {
+    if (time_mode == TURN_TIME_FOLLOW) return __atomic_load_n(&shared_time, __ATOMIC_RELAXED);
     return global_time;
 }
 
 void turn_clear(void) {
     heap_size = 0;
+    reset_slots();
+}
+
+void turn_export(TurnState* out) {
+    memcpy(out->heap, heap, heap_size * sizeof(GameEvent));
+    out->heap_size = heap_size;
+    out->global_time = global_time;
+    out->next_priority_id = next_priority_id;
+    memcpy(out->slot_heap_index, slot_heap_index, sizeof(slot_heap_index));
+    memcpy(out->slot_gen, slot_gen, sizeof(slot_gen));
+    memcpy(out->free_slots, free_slots, free_count * sizeof(int));
+    out->free_count = free_count;
+}
+
+void turn_import(const TurnState* in) {
+    memcpy(heap, in->heap, in->heap_size * sizeof(GameEvent));
+    heap_size = in->heap_size;
+    set_time(in->global_time);
+    next_priority_id = in->next_priority_id;
+    memcpy(slot_heap_index, in->slot_heap_index, sizeof(slot_heap_index));
+    memcpy(slot_gen, in->slot_gen, sizeof(slot_gen));
+    memcpy(free_slots, in->free_slots, in->free_count * sizeof(int));
+    free_count = in->free_count;
+}
+
+bool turn_state_valid(const TurnState* in) {
+    if (in->heap_size < 0 || in->heap_size > MAX_EVENTS) return false;
+    if (in->free_count < 0 || in->heap_size + in->free_count != MAX_EVENTS) return false;
+    if (in->global_time < 0 || in->next_priority_id < 0) return false;
+
+    // Every slot is either backing exactly one queued event or free, once
+    bool seen[MAX_EVENTS] = {false};
+    for (int i = 0; i < in->heap_size; i++) {
+        const GameEvent* evt = &in->heap[i];
+        if (evt->slot < 0 || evt->slot >= MAX_EVENTS || seen[evt->slot]) return false;
+        if (in->slot_heap_index[evt->slot] != i) return false;
+        if (evt->type < EVENT_MOVE || evt->type > EVENT_STATUS_TICK) return false;
+        if (i > 0 && compare(*evt, in->heap[(i - 1) / 2]) < 0) return false; // Heap order
+        seen[evt->slot] = true;
+    }
+    for (int i = 0; i < in->free_count; i++) {
+        int slot = in->free_slots[i];
+        if (slot < 0 || slot >= MAX_EVENTS || seen[slot]) return false;
+        if (in->slot_heap_index[slot] != -1) return false;
+        seen[slot] = true;
+    }
+    for (int i = 0; i < MAX_EVENTS; i++) {
+        if (in->slot_gen[i] < 1 || in->slot_gen[i] > EVENT_GEN_MASK) return false; // Generation 0 is never live
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Handles
+// ----------------------------------------------------------------------------
+
+bool turn_event_pending(EventHandle handle) {
+    return resolve_handle(handle) >= 0;
+}
+
+bool turn_reschedule(EventHandle handle, long new_time) {
+    int slot = resolve_handle(handle);
+    if (slot < 0) return false;
+
+    int idx = slot_heap_index[slot];
+    heap[idx].time = new_time;
+    heap[idx].priority_id = next_priority_id++; // Rescheduled events queue behind peers
+    if (sift_up(idx) == idx) {
+        sift_down(idx);
+    }
+    return true;
+}
+
+bool turn_cancel(EventHandle handle) {
+    int slot = resolve_handle(handle);
+    if (slot < 0) return false;
+
+    remove_at(slot_heap_index[slot]);
+    release_slot(slot);
+    return true;
 }
@@ -5,24 +5,69 @@
 
 // Priority Queue Scheduler
 
+// Nominal game speed used for reporting rates (DPS, TP/s): 100 ticks = 1 second
+#define TURN_TICKS_PER_SECOND 100
+
 typedef enum {
     EVENT_MOVE,
     EVENT_ATTACK_READY, // The moment an auto-attack swing happens
-    EVENT_RESPAWN_TICK  // Check for respawns (could be global or per entity)
+    EVENT_RESPAWN_TICK, // Check for respawns (could be global or per entity)
+    EVENT_STATUS_EXPIRE,// A status effect wears off (data = StatusEffectType)
+    EVENT_STATUS_TICK   // Periodic status effect pulse, e.g. Poison (data = StatusEffectType)
 } EventType;
 
 typedef struct {
     long time;           // Absolute game time
     EntityID entity_id;
     EventType type;
+    int data;            // Event specific payload
     long priority_id;    // Tie-breaker for insertion order
+    int slot;            // Internal: handle slot backing this event
 } GameEvent;
 
+// Every entity holds at most a move, an attack and an expiry plus a pulse per
+// status type: (MAX_ENTITIES + player) * (2 + 2 * (STATUS_MAX - 1)) = 1010.
+// Running out is fatal rather than silently dropping an event.
+#define TURN_MAX_EVENTS 1024
+
+// A thread's whole scheduler, handles included. The scheduler is per-thread,
+// so whoever moves the game to another thread carries this across.
+typedef struct {
+    GameEvent heap[TURN_MAX_EVENTS];
+    int heap_size;
+    long global_time;
+    long next_priority_id;
+    int slot_heap_index[TURN_MAX_EVENTS];
+    int slot_gen[TURN_MAX_EVENTS];
+    int free_slots[TURN_MAX_EVENTS];
+    int free_count;
+} TurnState;
+
+void turn_export(TurnState* out);
+void turn_import(const TurnState* in);
+bool turn_state_valid(const TurnState* in); // Safe to import (e.g. read from a file)
+
+// Whose clock turn_get_current_time reads on the calling thread
+typedef enum {
+    TURN_TIME_OWN,     // Its own scheduler's (the default)
+    TURN_TIME_PUBLISH, // Its own, shared with threads that follow
+    TURN_TIME_FOLLOW   // The publishing thread's; for a thread that handed its scheduler over
+} TurnTimeMode;
+void turn_set_time_mode(TurnTimeMode mode);
+
 void turn_init(void);
-void turn_add_event(long time, EntityID entity_id, EventType type);
+EventHandle turn_add_event(long time, EntityID entity_id, EventType type);
+EventHandle turn_add_event_data(long time, EntityID entity_id, EventType type, int data);
 GameEvent turn_pop_event(void);
 bool turn_queue_is_empty(void);
+long turn_next_time(void); // Time of the next event; -1 if none
 long turn_get_current_time(void);
 void turn_clear(void);
 
+// Handles
+// A handle stays valid until its event is popped, cancelled or the queue is cleared.
+bool turn_event_pending(EventHandle handle);
+bool turn_reschedule(EventHandle handle, long new_time);
+bool turn_cancel(EventHandle handle);
+
 #endif
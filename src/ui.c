@@ -4,10 +4,14 @@
 #include <locale.h>
 #include <stdarg.h>
 #include <stdlib.h> // for setenv
+#include <stdint.h>
+#include <time.h>
 
 #include <string.h>
 #include "ui.h"
-#include "turn.h"
+#include "evlog.h"
+#include "term.h"
+#include "minimap.h"
 
 // Layout Definitions
 // Defaults for Game Loop
@@ -19,33 +23,367 @@ static int layout_map_width = 54;
 static int layout_panel_width = 26;
 // Heights are constant for now
 #define MAP_VIEW_HEIGHT 17
+#if UI_MAP_VIEW_ROWS != MAP_VIEW_HEIGHT + 1
+#error "UI_MAP_VIEW_ROWS must cover the map area"
+#endif
 #define LOG_HEIGHT 6
 #define INPUT_HEIGHT 1
 #define PANEL_HEIGHT 24
 
-static WINDOW *win_map;
-static WINDOW *win_panel;
-static WINDOW *win_log;
-static WINDOW *win_input;
-static WINDOW *win_menu; // Menu Window
+// ----------------------------------------------------------------------------
+// Framebuffer
+// Everything is composed into `frame`; ui_refresh compares it with `shown`
+// (what the terminal has) and sends only the cells that changed, one
+// attribute run at a time. An idle screen costs no terminal output.
+// ----------------------------------------------------------------------------
 
-// Simple log buffer
-#define MAX_LOG_LINES 50
-static char log_history[MAX_LOG_LINES][64];
-//static int log_head = 0;
-static int log_count = 0;
-static int animation_frame = 0;
+#define UI_SCREEN_WIDTH 80
+#define UI_SCREEN_HEIGHT 24
 
-void ui_init(void) {
-    // Reduce ESC delay to 25ms to prevent menu exit lag
-    setenv("ESCDELAY", "25", 1);
-    
-    setlocale(LC_ALL, ""); // Enable wide chars
-    initscr();
+#define UI_ATTR_BOLD    TERM_ATTR_BOLD
+#define UI_ATTR_DIM     TERM_ATTR_DIM
+#define UI_ATTR_REVERSE TERM_ATTR_REVERSE
+
+static UIBackend backend = UI_BACKEND_CURSES;
+
+typedef struct {
+    uint32_t ch;   // Unicode code point
+    uint8_t attr;  // UI_ATTR_*
+    uint8_t pair;  // Colour pair
+} UICell;
+
+// Screen areas (formerly one ncurses window each)
+typedef struct {
+    int x, y, w, h;
+} UIRect;
+
+static UIRect rect_map, rect_panel, rect_log, rect_input, rect_menu;
+static bool menu_open = false;
+
+static UICell frame[UI_SCREEN_HEIGHT][UI_SCREEN_WIDTH];
+static UICell shown[UI_SCREEN_HEIGHT][UI_SCREEN_WIDTH];
+static int cursor_x = 0, cursor_y = 0; // Where the input cursor sits
+
+static const UICell BLANK = {' ', 0, 2};
+static const UICell STALE = {0xFFFFFFFF, 0, 0}; // Never drawn, forces a resend
+
+#define GLYPH_HLINE    0x2500
+#define GLYPH_VLINE    0x2502
+#define GLYPH_ULCORNER 0x250C
+#define GLYPH_URCORNER 0x2510
+#define GLYPH_LLCORNER 0x2514
+#define GLYPH_LRCORNER 0x2518
+#define GLYPH_LTEE     0x251C
+#define GLYPH_RTEE     0x2524
+#define GLYPH_TTEE     0x252C
+#define GLYPH_BTEE     0x2534
+#define GLYPH_PLUS     0x253C
+#define GLYPH_SHADE    0x2591
+#define GLYPH_CKBOARD  0x2592
+#define GLYPH_BLOCK    0x2588
+
+static void fb_invalidate(int y0, int y1) {
+    for (int y = y0; y < y1 && y < UI_SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < UI_SCREEN_WIDTH; x++) shown[y][x] = STALE;
+    }
+}
+
+static void fb_put(const UIRect* r, int x, int y, uint32_t ch, uint8_t attr, uint8_t pair) {
+    if (x < 0 || y < 0 || x >= r->w || y >= r->h) return;
+    int sx = r->x + x, sy = r->y + y;
+    if (sx >= UI_SCREEN_WIDTH || sy >= UI_SCREEN_HEIGHT) return;
+    frame[sy][sx] = (UICell){ch, attr, pair};
+}
+
+static void fb_fill(const UIRect* r, UICell c) {
+    for (int y = 0; y < r->h; y++) {
+        for (int x = 0; x < r->w; x++) fb_put(r, x, y, c.ch, c.attr, c.pair);
+    }
+}
+
+// Like mvwprintw: ASCII text, clipped to the rect. Returns the column after it.
+static int fb_print(const UIRect* r, int x, int y, uint8_t attr, uint8_t pair, const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    for (const char* c = buf; *c; c++) fb_put(r, x++, y, (unsigned char)*c, attr, pair);
+    return x;
+}
+
+static void fb_box(const UIRect* r, uint8_t pair) {
+    for (int x = 1; x < r->w - 1; x++) {
+        fb_put(r, x, 0, GLYPH_HLINE, 0, pair);
+        fb_put(r, x, r->h - 1, GLYPH_HLINE, 0, pair);
+    }
+    for (int y = 1; y < r->h - 1; y++) {
+        fb_put(r, 0, y, GLYPH_VLINE, 0, pair);
+        fb_put(r, r->w - 1, y, GLYPH_VLINE, 0, pair);
+    }
+    fb_put(r, 0, 0, GLYPH_ULCORNER, 0, pair);
+    fb_put(r, r->w - 1, 0, GLYPH_URCORNER, 0, pair);
+    fb_put(r, 0, r->h - 1, GLYPH_LLCORNER, 0, pair);
+    fb_put(r, r->w - 1, r->h - 1, GLYPH_LRCORNER, 0, pair);
+}
+
+static bool cell_equal(const UICell* a, const UICell* b) {
+    return a->ch == b->ch && a->attr == b->attr && a->pair == b->pair;
+}
+
+static attr_t curses_attr(uint8_t attr) {
+    attr_t a = A_NORMAL;
+    if (attr & UI_ATTR_BOLD) a |= A_BOLD;
+    if (attr & UI_ATTR_DIM) a |= A_DIM;
+    if (attr & UI_ATTR_REVERSE) a |= A_REVERSE;
+    return a;
+}
+
+// Line drawing goes through ncurses' WACS table so it still works outside
+// UTF-8 locales. NULL for everything else.
+static const cchar_t* curses_line_glyph(uint32_t ch) {
+    switch (ch) {
+        case GLYPH_HLINE: return WACS_HLINE;
+        case GLYPH_VLINE: return WACS_VLINE;
+        case GLYPH_ULCORNER: return WACS_ULCORNER;
+        case GLYPH_URCORNER: return WACS_URCORNER;
+        case GLYPH_LLCORNER: return WACS_LLCORNER;
+        case GLYPH_LRCORNER: return WACS_LRCORNER;
+        case GLYPH_LTEE: return WACS_LTEE;
+        case GLYPH_RTEE: return WACS_RTEE;
+        case GLYPH_TTEE: return WACS_TTEE;
+        case GLYPH_BTEE: return WACS_BTEE;
+        case GLYPH_PLUS: return WACS_PLUS;
+        case GLYPH_CKBOARD: return WACS_CKBOARD;
+        case GLYPH_BLOCK: return WACS_BLOCK;
+        default: return NULL;
+    }
+}
+
+// ANSI backend: term.c skips cursor moves and SGRs the terminal already has
+static void fb_flush_ansi(int y0, int y1) {
+    for (int y = y0; y < y1; y++) {
+        for (int x = 0; x < UI_SCREEN_WIDTH; x++) {
+            if (cell_equal(&frame[y][x], &shown[y][x])) continue;
+            const UICell* c = &frame[y][x];
+            term_cell(x, y, c->ch, c->attr, c->pair);
+            shown[y][x] = *c;
+        }
+    }
+}
+
+// Sends changed cells. A run continues while cells differ from what is shown
+// and share attributes, so each run is one attr_set and one string write.
+static void fb_flush(int y0, int y1) {
+    wchar_t run[UI_SCREEN_WIDTH + 1];
+
+    for (int y = y0; y < y1; y++) {
+        int x = 0;
+        while (x < UI_SCREEN_WIDTH) {
+            if (cell_equal(&frame[y][x], &shown[y][x])) {
+                x++;
+                continue;
+            }
+
+            uint8_t attr = frame[y][x].attr;
+            uint8_t pair = frame[y][x].pair;
+            attr_set(curses_attr(attr), pair, NULL);
+            move(y, x);
+
+            int n = 0;
+            while (x < UI_SCREEN_WIDTH && !cell_equal(&frame[y][x], &shown[y][x]) &&
+                   frame[y][x].attr == attr && frame[y][x].pair == pair) {
+                const cchar_t* line = curses_line_glyph(frame[y][x].ch);
+                if (line) {
+                    if (n > 0) addnwstr(run, n);
+                    n = 0;
+                    add_wch(line);
+                } else {
+                    run[n++] = (wchar_t)frame[y][x].ch;
+                }
+                shown[y][x] = frame[y][x];
+                x++;
+            }
+            if (n > 0) addnwstr(run, n);
+        }
+    }
+    attr_set(A_NORMAL, 2, NULL);
+}
+
+// ----------------------------------------------------------------------------
+// Glyph Cache
+// Every cell the map view can show, built once by ui_init. Drawing a tile is
+// a table lookup; entries that don't depend on the wall mask or the
+// animation phase simply repeat the same cell.
+// ----------------------------------------------------------------------------
+
+#define TILE_TYPE_COUNT (TILE_TELEPORT + 1)
+#define WALL_MASKS 16
+#define ANIM_PHASES 4
+#define SMELL_LEVELS 256
+#define SOUND_STATES 3
+
+enum { VIS_UNSEEN, VIS_EXPLORED, VIS_VISIBLE, VIS_COUNT };
+
+// Wall Mask Directions
+enum { DIR_N = 1, DIR_E = 2, DIR_S = 4, DIR_W = 8 };
+
+static const uint32_t WALL_GLYPHS[WALL_MASKS] = {
+    GLYPH_BLOCK,    // Isolated
+    GLYPH_VLINE,    // N
+    GLYPH_HLINE,    // E
+    GLYPH_LLCORNER, // N E
+    GLYPH_VLINE,    // S
+    GLYPH_VLINE,    // N S
+    GLYPH_ULCORNER, // E S
+    GLYPH_LTEE,     // N E S
+    GLYPH_HLINE,    // W
+    GLYPH_LRCORNER, // N W
+    GLYPH_HLINE,    // E W
+    GLYPH_BTEE,     // N E W
+    GLYPH_URCORNER, // S W
+    GLYPH_RTEE,     // N S W
+    GLYPH_TTEE,     // E S W
+    GLYPH_PLUS      // All
+};
+
+static UICell tile_glyphs[TILE_TYPE_COUNT][WALL_MASKS][VIS_COUNT][ANIM_PHASES];
+static UICell smell_glyphs[SMELL_LEVELS];
+static UICell sound_glyphs[SOUND_STATES];
+static UICell minimap_glyphs[MINIMAP_KIND_COUNT][16];
+
+// Quadrant blocks by minimap mask (1 = NW, 2 = NE, 4 = SW, 8 = SE)
+static const uint32_t QUADRANT_GLYPHS[16] = {
+    ' ',    0x2598, 0x259D, 0x2580, 0x2596, 0x258C, 0x259E, 0x259B,
+    0x2597, 0x259A, 0x2590, 0x259C, 0x2584, 0x2599, 0x259F, GLYPH_BLOCK
+};
+
+static UICell make_tile_glyph(TileType type, int mask, int vis, int phase) {
+    if (vis == VIS_UNSEEN) return BLANK;
+    uint8_t attrs = (vis == VIS_EXPLORED) ? UI_ATTR_DIM : 0;
+
+    switch (type) {
+        case TILE_FLOOR: return (UICell){'.', attrs, 2};
+        case TILE_WALL: return (UICell){WALL_GLYPHS[mask], attrs, 2};
+        case TILE_WATER: {
+            // Animation: Cycle colors 10, 11, 12 based on frame + position
+            uint8_t color_idx = 10; // Blue
+            if (phase == 1 || phase == 3) color_idx = 11; // Cyan
+            if (phase == 2) color_idx = 12; // White (Sparkle)
+            return (UICell){'~', 0, color_idx};
+        }
+        case TILE_BRIDGE: return (UICell){'=', 0, 13};
+        case TILE_ZONE: return (UICell){GLYPH_SHADE, 0, 2};
+        case TILE_TELEPORT: return (UICell){GLYPH_SHADE, phase == 2 ? UI_ATTR_BOLD : 0, 14}; // Shimmer
+        default: return BLANK;
+    }
+}
+
+// Tiles whose glyph changes with the animation phase
+static bool tile_animated(TileType type) {
+    return type == TILE_WATER || type == TILE_TELEPORT;
+}
+
+static void build_glyph_cache(void) {
+    for (int t = 0; t < TILE_TYPE_COUNT; t++) {
+        for (int m = 0; m < WALL_MASKS; m++) {
+            for (int v = 0; v < VIS_COUNT; v++) {
+                for (int p = 0; p < ANIM_PHASES; p++) {
+                    tile_glyphs[t][m][v][p] = make_tile_glyph((TileType)t, m, v, p);
+                }
+            }
+        }
+    }
+
+    smell_glyphs[0] = (UICell){'.', 0, 2};
+    for (int s = 1; s < SMELL_LEVELS; s++) {
+        uint8_t attrs = s >= 128 ? UI_ATTR_BOLD : (s < 64 ? UI_ATTR_DIM : 0);
+        smell_glyphs[s] = (UICell){GLYPH_BLOCK, attrs, 3}; // Red
+    }
+
+    static const uint8_t MINIMAP_PAIRS[MINIMAP_KIND_COUNT] = {2, 2, 13, 10, 14};
+    for (int k = 0; k < MINIMAP_KIND_COUNT; k++) {
+        for (int m = 0; m < 16; m++) minimap_glyphs[k][m] = (UICell){QUADRANT_GLYPHS[m], 0, MINIMAP_PAIRS[k]};
+    }
+
+    sound_glyphs[SOUND_NONE] = (UICell){'.', 0, 2};
+    sound_glyphs[SOUND_CLEAR] = (UICell){GLYPH_BLOCK, UI_ATTR_BOLD, 5};     // Blue
+    sound_glyphs[SOUND_MUFFLED] = (UICell){GLYPH_CKBOARD, UI_ATTR_DIM, 6};  // Cyan
+}
+
+// Known-wall flags for columns x0-1 .. x0+n of row y, so each cell's wall
+// mask is four array reads.
+static void known_wall_row(const MapView* view, int y, int x0, int n, uint8_t* out) {
+    for (int i = 0; i < n + 2; i++) {
+        int x = x0 - 1 + i;
+        out[i] = 0;
+        if (x < view->x0 || y < view->y0 || x >= view->x1 || y >= view->y1) continue;
+        const Tile* t = &view->tiles[x - view->x0][y - view->y0];
+        out[i] = (t->visible || t->explored) && t->type == TILE_WALL;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Animation
+// Animated tiles step on a monotonic clock, independent of input. Each map
+// render records where they landed on screen, and ui_animate redraws only
+// those cells when the step changes.
+// ----------------------------------------------------------------------------
+
+#define ANIM_STEP_MS 300
+
+typedef struct {
+    uint8_t sx, sy;  // Screen position
+    uint8_t type;    // TileType
+    uint8_t vis;
+    uint8_t offset;  // (x + y) % ANIM_PHASES, so neighbours ripple
+} UIAnimCell;
+
+static UIAnimCell anim_cells[MAP_VIEW_HEIGHT * UI_SCREEN_WIDTH];
+static int anim_count = 0;
+static long anim_step = 0; // Step the animated cells currently show
+static struct timespec anim_epoch;
+
+static long anim_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec - anim_epoch.tv_sec) * 1000L + (ts.tv_nsec - anim_epoch.tv_nsec) / 1000000L;
+}
+
+static UICell anim_glyph(const UIAnimCell* a, long step) {
+    return tile_glyphs[a->type][0][a->vis][(a->offset + step) % ANIM_PHASES];
+}
+
+// ----------------------------------------------------------------------------
+// Setup
+// ----------------------------------------------------------------------------
+
+static int cursor_shown = -1; // Unknown until first set
+
+// curs_set costs terminal output every call, so only send changes
+static void show_cursor(bool show) {
+    if (cursor_shown == (int)show) return;
+    if (backend == UI_BACKEND_ANSI) term_cursor(cursor_x, cursor_y, show);
+    else curs_set(show ? 1 : 0);
+    cursor_shown = show;
+}
+
+static SCREEN* stream_screen = NULL; // Set by ui_init_stream
+
+static void setup_common(void) {
+    build_glyph_cache();
+    clock_gettime(CLOCK_MONOTONIC, &anim_epoch);
+    ui_set_layout(UI_LAYOUT_GAME); // Default
+}
+
+// Everything after the ncurses screen exists
+static void setup_screen(void) {
+    cursor_shown = -1;
     cbreak();
     noecho();
     keypad(stdscr, TRUE);
-    curs_set(0); // Hide cursor initially
+    show_cursor(false); // Hide cursor initially
 
     if (has_colors()) {
         start_color();
@@ -58,8 +396,6 @@ void ui_init(void) {
         // Water Animation Colors
         init_pair(10, COLOR_BLUE, COLOR_BLACK);
         init_pair(11, COLOR_CYAN, COLOR_BLACK);
-        init_pair(10, COLOR_BLUE, COLOR_BLACK);
-        init_pair(11, COLOR_CYAN, COLOR_BLACK);
         init_pair(12, COLOR_WHITE, COLOR_BLACK);
         init_pair(14, COLOR_MAGENTA, COLOR_BLACK); // Teleport
 
@@ -76,14 +412,48 @@ void ui_init(void) {
     bkgd(COLOR_PAIR(2)); // Force stdscr to black
     refresh(); // Refresh stdscr
 
-    // Create Windows
+    setup_common();
+}
 
-    // Initial Layout is Game Default? Or Creator?
-    // We'll let game logic call ui_set_layout.
-    // For init, we don't create windows yet. ui_set_layout will do it.
-    // But we need to be safe if render called before layout.
+void ui_set_backend(UIBackend b) {
+    backend = b;
+}
+
+void ui_init(void) {
+    if (backend == UI_BACKEND_ANSI) {
+        if (!term_open()) {
+            fprintf(stderr, "FATAL: --ansi needs a terminal on stdin and stdout\n");
+            exit(1);
+        }
+        cursor_shown = 0;
+        setup_common();
+        return;
+    }
+
+    // Reduce ESC delay to 25ms to prevent menu exit lag
+    setenv("ESCDELAY", "25", 1);
     
-    ui_set_layout(UI_LAYOUT_GAME); // Default
+    setlocale(LC_ALL, ""); // Enable wide chars
+    initscr();
+    setup_screen();
+}
+
+void ui_init_stream(FILE* out, FILE* in) {
+    if (backend == UI_BACKEND_ANSI) {
+        term_open_headless(fileno(out));
+        cursor_shown = 0;
+        setup_common();
+        return;
+    }
+
+    setlocale(LC_ALL, "");
+    stream_screen = newterm(NULL, out, in);
+    if (!stream_screen) {
+        fprintf(stderr, "FATAL: Could not open a terminal for TERM=%s\n", getenv("TERM") ? getenv("TERM") : "(unset)");
+        exit(1);
+    }
+    set_term(stream_screen);
+    setup_screen();
 }
 
 void ui_set_layout(UILayout layout) {
@@ -95,266 +465,153 @@ void ui_set_layout(UILayout layout) {
         layout_panel_width = 40;
     }
 
-    if (win_map) delwin(win_map);
-    if (win_panel) delwin(win_panel);
-    if (win_log) delwin(win_log);
-    if (win_input) delwin(win_input);
-    if (win_menu) { delwin(win_menu); win_menu = NULL; }
+    rect_map = (UIRect){0, 0, layout_map_width, MAP_VIEW_HEIGHT};
+    rect_panel = (UIRect){layout_map_width, 0, layout_panel_width, PANEL_HEIGHT};
+    rect_log = (UIRect){0, MAP_VIEW_HEIGHT, layout_map_width, LOG_HEIGHT};
+    rect_input = (UIRect){0, MAP_VIEW_HEIGHT + LOG_HEIGHT, layout_map_width, INPUT_HEIGHT};
+    menu_open = false;
 
-    win_map = newwin(MAP_VIEW_HEIGHT, layout_map_width, 0, 0);
-    win_panel = newwin(PANEL_HEIGHT, layout_panel_width, 0, layout_map_width);
-    win_log = newwin(LOG_HEIGHT, layout_map_width, MAP_VIEW_HEIGHT, 0);
-    win_input = newwin(INPUT_HEIGHT, layout_map_width, MAP_VIEW_HEIGHT + LOG_HEIGHT, 0);
-    
-    keypad(win_input, TRUE);
-
-    wbkgd(win_map, COLOR_PAIR(2));
-    wbkgd(win_panel, COLOR_PAIR(2));
-    wbkgd(win_log, COLOR_PAIR(2));
-    wbkgd(win_input, COLOR_PAIR(2));
-    
-    refresh();
-
-    // Force background to black for all windows
-    wbkgd(win_map, COLOR_PAIR(2));
-    wbkgd(win_panel, COLOR_PAIR(2));
-    wbkgd(win_log, COLOR_PAIR(2));
-    wbkgd(win_input, COLOR_PAIR(2));
+    // New layout: clear and resend everything
+    ui_clear();
+    fb_invalidate(0, UI_SCREEN_HEIGHT);
 }
 
 void ui_cleanup(void) {
-    delwin(win_map);
-    delwin(win_panel);
-    delwin(win_log);
-    delwin(win_input);
-    if (win_menu) delwin(win_menu);
+    if (backend == UI_BACKEND_ANSI) {
+        term_close();
+        return;
+    }
     endwin();
+    if (stream_screen) {
+        delscreen(stream_screen);
+        stream_screen = NULL;
+    }
 }
 
 void ui_clear(void) {
-    werase(win_map);
-    werase(win_panel);
-    werase(win_log);
-    werase(win_input);
-    if (win_menu) werase(win_menu);
-    
-    // Draw borders/separators if needed
-    // Typically box() takes character space, but our layout implies tight packing.
-    // We'll trust the layout for now.
+    for (int y = 0; y < UI_SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < UI_SCREEN_WIDTH; x++) frame[y][x] = BLANK;
+    }
+    if (menu_open) fb_fill(&rect_menu, (UICell){' ', 0, 4});
+    anim_count = 0;
 }
 
-// Wall Mask Directions
-enum { DIR_N = 1, DIR_E = 2, DIR_S = 4, DIR_W = 8 };
-
-static cchar_t* get_wall_glyph(int mask) {
-    static cchar_t* table[16] = {0};
-    static bool inited = false;
-    if (!inited) {
-        table[0] = WACS_BLOCK; // Isolated?
-        table[1] = WACS_VLINE;
-        table[2] = WACS_HLINE;
-        table[3] = WACS_LLCORNER;
-        table[4] = WACS_VLINE;
-        table[5] = WACS_VLINE;
-        table[6] = WACS_ULCORNER;
-        table[7] = WACS_LTEE;
-        table[8] = WACS_HLINE;
-        table[9] = WACS_LRCORNER;
-        table[10] = WACS_HLINE;
-        table[11] = WACS_BTEE;
-        table[12] = WACS_URCORNER;
-        table[13] = WACS_RTEE;
-        table[14] = WACS_TTEE;
-        table[15] = WACS_PLUS;
-
-        inited = true;
-    }
-    if (mask == 0)
-        return table[0]; // Return consistent WACS_BLOCK instead of NULL
-    return table[mask];
-}
-
-static bool tile_is_known_wall(const Map* map, int x, int y) {
-    if (x < 0 || y < 0 || x >= map->width || y >= map->height) return false;
-    const Tile* t = &map->tiles[x][y];
-    if (!(t->visible || t->explored)) return false;
-    return t->type == TILE_WALL;
-}
-
-static int wall_mask_at(const Map* map, int x, int y) {
-    int m = 0;
-    if (tile_is_known_wall(map, x, y-1)) m |= DIR_N;
-    if (tile_is_known_wall(map, x+1, y)) m |= DIR_E;
-    if (tile_is_known_wall(map, x, y+1)) m |= DIR_S;
-    if (tile_is_known_wall(map, x-1, y)) m |= DIR_W;
-    return m;
-}
-
-static void mvwadd_wchar(WINDOW* win, int y, int x, wchar_t wch) {
-    cchar_t c;
-    wchar_t w[2] = {wch, 0};
-    setcchar(&c, w, A_NORMAL, 0, NULL);
-    mvwadd_wch(win, y, x, &c);
-}
-
-void ui_render_map(Map* map, const Entity* player, const Entity entities[], int entity_count, RenderMode mode) {
-    // Basic rendering 
-    werase(win_map);
-
-    // Draw Title Bar
-    wattron(win_map, A_BOLD);
-    mvwprintw(win_map, 0, 0, "[ %s ]", map->name);
-    wattroff(win_map, A_BOLD);
+static EntityID target_id = -1; // Drawn in reverse video
 
-    scrollok(win_map, FALSE);
+void ui_set_target(EntityID id) {
+    target_id = id;
+}
 
-    // Camera Calculation
-    int cam_x = player->x - (layout_map_width / 2);
-    int cam_y = player->y - (MAP_VIEW_HEIGHT / 2);
+// Top-left map tile of the viewport: centred on the player, clamped
+static void map_camera(int width, int height, const Entity* player, int* cam_x, int* cam_y) {
+    *cam_x = player->x - (layout_map_width / 2);
+    *cam_y = player->y - (MAP_VIEW_HEIGHT / 2);
 
     // Clamping
-    int max_cam_x = map->width - layout_map_width;
-    int max_cam_y = map->height - MAP_VIEW_HEIGHT;
+    int max_cam_x = width - layout_map_width;
+    int max_cam_y = height - MAP_VIEW_HEIGHT;
 
     if (max_cam_x < 0) max_cam_x = 0;
     if (max_cam_y < 0) max_cam_y = 0;
 
-    if (cam_x < 0) cam_x = 0;
-    if (cam_y < 0) cam_y = 0;
-    if (cam_x > max_cam_x) cam_x = max_cam_x;
-    if (cam_y > max_cam_y) cam_y = max_cam_y;
+    if (*cam_x < 0) *cam_x = 0;
+    if (*cam_y < 0) *cam_y = 0;
+    if (*cam_x > max_cam_x) *cam_x = max_cam_x;
+    if (*cam_y > max_cam_y) *cam_y = max_cam_y;
+}
+
+void ui_map_view_fill(MapView* view, const Map* map, const Entity* player) {
+    int cam_x, cam_y;
+    map_camera(map->width, map->height, player, &cam_x, &cam_y);
+
+    // Wall masks look one tile past each edge
+    view->x0 = cam_x > 0 ? cam_x - 1 : 0;
+    view->y0 = cam_y > 0 ? cam_y - 1 : 0;
+    view->x1 = cam_x + layout_map_width + 1;
+    view->y1 = cam_y + MAP_VIEW_HEIGHT;
+    if (view->x1 > map->width) view->x1 = map->width;
+    if (view->y1 > map->height) view->y1 = map->height;
+
+    // Tiles are stored column-major
+    int rows = view->y1 - view->y0;
+    for (int x = view->x0; x < view->x1 && rows > 0; x++) {
+        int vx = x - view->x0;
+        memcpy(view->tiles[vx], &map->tiles[x][view->y0], rows * sizeof(Tile));
+        for (int vy = 0; vy < rows; vy++) {
+            view->smell[vx][vy] = (uint8_t)map->smell[x][view->y0 + vy];
+            view->sound[vx][vy] = (uint8_t)map->sound[x][view->y0 + vy];
+        }
+    }
+
+    memcpy(view->name, map->name, sizeof(view->name));
+    view->width = map->width;
+    view->height = map->height;
+    if (view->minimap.version != map->minimap.version) view->minimap = map->minimap;
+}
+
+void ui_render_map(const MapView* view, const Entity* player, const Entity entities[], int entity_count, RenderMode mode) {
+    const UIRect* r = &rect_map;
+    fb_fill(r, BLANK);
+
+    // Draw Title Bar
+    fb_print(r, 0, 0, UI_ATTR_BOLD, 2, "[ %s ]", view->name);
 
-    // Draw Map (Viewport Loop)
-    for (int vy = 0; vy < MAP_VIEW_HEIGHT; vy++) {
-        // Map Y coordinate
+    int cam_x, cam_y;
+    map_camera(view->width, view->height, player, &cam_x, &cam_y);
+
+    // Draw Map (Viewport Loop). Map rows start below the title bar.
+    int cols = layout_map_width;
+    if (cols > view->width - cam_x) cols = view->width - cam_x;
+    anim_step = anim_now_ms() / ANIM_STEP_MS;
+    anim_count = 0;
+
+    uint8_t wall_rows[3][UI_SCREEN_WIDTH + 2];
+    uint8_t* above = wall_rows[0];
+    uint8_t* row = wall_rows[1];
+    uint8_t* below = wall_rows[2];
+    known_wall_row(view, cam_y - 1, cam_x, cols, above);
+    known_wall_row(view, cam_y, cam_x, cols, row);
+
+    for (int vy = 0; vy < MAP_VIEW_HEIGHT - 1; vy++) {
         int y = cam_y + vy;
-        
-        // Window Y (account for title bar offset +1)
-        // Wait, title bar is at 0. Map starts at 1.
-        // But MAP_VIEW_HEIGHT includes the title bar row?
-        // No, MAP_VIEW_HEIGHT is the total height of the window (17).
-        // If we draw map rows 0..15 (16 rows) starting at win_y 1..16.
-        // We should loop vy from 0 to MAP_VIEW_HEIGHT - 2 ? (Total 16 lines).
-        
-        // Let's stick to the previous logic:
-        // win_y = vy + 1. If win_y >= MAP_VIEW_HEIGHT continue.
-        // But previously 'y' was the map coordinate.
-        // Now 'vy' is viewport relative map offset.
-        
-        int win_y = vy + 1;
-        if (win_y >= MAP_VIEW_HEIGHT) continue;
-        if (y >= map->height) continue;
+        if (y >= view->height) break;
+        known_wall_row(view, y + 1, cam_x, cols, below);
 
-        for (int vx = 0; vx < layout_map_width; vx++) {
-            // Map X coordinate
+        UICell* out = &frame[r->y + vy + 1][r->x];
+        for (int vx = 0; vx < cols; vx++) {
             int x = cam_x + vx;
-            if (x >= map->width) continue;
-
-            // Render Mode Logic
-            if (mode == RENDER_MODE_SMELL) {
-                 if (map->tiles[x][y].type == TILE_WALL) {
-                     // Draw walls normally
-                 } else {
-                     // Floor
-                     int smell = map->smell[x][y];
-                     int color = 3; // Red
-                     attr_t attrs = A_NORMAL;
-                     
-                     if (smell == 0) {
-                         wattr_set(win_map, A_NORMAL, 2, NULL);
-                         mvwaddch(win_map, win_y, vx, '.');
-                         continue;
-                     } 
-                     
-                     if (smell >= 128) attrs = A_BOLD;
-                     else if (smell < 64) attrs = A_DIM;
-                     
-                     wattr_set(win_map, attrs, color, NULL);
-                     mvwadd_wch(win_map, win_y, vx, WACS_BLOCK);
-                     continue;
-                 }
-            }
-            else if (mode == RENDER_MODE_SOUND) {
-                if (map->tiles[x][y].type == TILE_WALL) {
-                    // Draw walls normally 
-                } else {
-                    SoundState sound = map->sound[x][y];
-                    if (sound == SOUND_CLEAR) {
-                        wattr_set(win_map, A_BOLD, 5, NULL); // Blue
-                        mvwadd_wch(win_map, win_y, vx, WACS_BLOCK);
-                        continue;
-                    } else if (sound == SOUND_MUFFLED) {
-                        wattr_set(win_map, A_DIM, 6, NULL); // Cyan
-                        mvwadd_wch(win_map, win_y, vx, WACS_CKBOARD);
-                        continue;
-                    } else {
-                         wattr_set(win_map, A_NORMAL, 2, NULL);
-                         mvwaddch(win_map, win_y, vx, '.');
-                         continue;
-                    }
-                }
-            }
+            int tx = x - view->x0, ty = y - view->y0;
+            const Tile* t = &view->tiles[tx][ty];
 
-            // Normal / Fallback Rendering
-            bool visible = map->tiles[x][y].visible;
-            bool explored = map->tiles[x][y].explored;
-            
-            if (mode != RENDER_MODE_NORMAL) {
-                visible = true; 
-                explored = true;
-            }
-
-            if (!visible && !explored) {
-                mvwaddch(win_map, win_y, vx, ' ');
-                continue;
-            }
+            int vis = t->visible ? VIS_VISIBLE : (t->explored ? VIS_EXPLORED : VIS_UNSEEN);
+            int mask = above[vx + 1] * DIR_N | row[vx + 2] * DIR_E | below[vx + 1] * DIR_S | row[vx] * DIR_W;
+            int phase = (x + y + anim_step) % ANIM_PHASES;
 
-            int color = 2; // Default
-            attr_t attrs = A_NORMAL;
-            
-            if (!visible && explored) {
-                attrs |= A_DIM; 
-            }
+            // Debug views show every tile; walls draw normally in every mode
+            if (mode == RENDER_MODE_NORMAL) {
+                out[vx] = tile_glyphs[t->type][mask][vis][phase];
 
-            wattr_set(win_map, attrs, color, NULL); 
-            
-            if (map->tiles[x][y].type == TILE_FLOOR) {
-                mvwaddch(win_map, win_y, vx, '.');
-            } 
-            else if (map->tiles[x][y].type == TILE_WATER) {
-                // Animation: Cycle colors 10, 11, 12 based on frame + position
-                // Phase 0..3
-                int phase = (x + y + (animation_frame / 2)) % 4;
-                int color_idx = 10; // Blue
-                if (phase == 1 || phase == 3) color_idx = 11; // Cyan
-                if (phase == 2) color_idx = 12; // White (Sparkle)
-                
-                wattr_set(win_map, A_NORMAL, color_idx, NULL);
-                mvwaddch(win_map, win_y, vx, '~');
-            }
-            else if (map->tiles[x][y].type == TILE_WALL) {
-                int mask = wall_mask_at(map, x, y);
-                cchar_t* wglyph = get_wall_glyph(mask);
-                
-                if (wglyph) {
-                    mvwadd_wch(win_map, win_y, vx, wglyph);
-                } else {
-                    mvwaddch(win_map, win_y, vx, '#'); 
-                }
-            } else if (map->tiles[x][y].type == TILE_BRIDGE) {
-                wattr_set(win_map, A_NORMAL, 13, NULL);
-                mvwaddch(win_map, win_y, vx, '=');
-            } else if (map->tiles[x][y].type == TILE_ZONE) {
-                wattr_set(win_map, A_NORMAL, 2, NULL);
-                mvwadd_wchar(win_map, win_y, vx, 0x2591);
-            } else if (map->tiles[x][y].type == TILE_TELEPORT) {
-                wattr_set(win_map, A_NORMAL, 14, NULL);
-                mvwadd_wchar(win_map, win_y, vx, 0x2591);
+                UIAnimCell* a = &anim_cells[anim_count];
+                a->sx = (uint8_t)(r->x + vx);
+                a->sy = (uint8_t)(r->y + vy + 1);
+                a->type = (uint8_t)t->type;
+                a->vis = (uint8_t)vis;
+                a->offset = (uint8_t)((x + y) % ANIM_PHASES);
+                anim_count += tile_animated(t->type) && vis != VIS_UNSEEN;
+            } else if (t->type == TILE_WALL) {
+                out[vx] = tile_glyphs[TILE_WALL][mask][VIS_VISIBLE][0];
+            } else if (mode == RENDER_MODE_SMELL) {
+                int smell = view->smell[tx][ty];
+                out[vx] = smell_glyphs[smell < SMELL_LEVELS ? smell : SMELL_LEVELS - 1];
             } else {
-                mvwaddch(win_map, win_y, vx, ' '); 
+                out[vx] = sound_glyphs[view->sound[tx][ty]];
             }
-            wattr_set(win_map, A_NORMAL, 0, NULL);
         }
+
+        uint8_t* recycled = above;
+        above = row;
+        row = below;
+        below = recycled;
     }
     
     // 2. Render Objects / NPCs / Enemies
@@ -368,16 +625,15 @@ void ui_render_map(Map* map, const Entity* player, const Entity entities[], int
         int screen_y = entities[i].y - cam_y;
         
         if (screen_x < 0 || screen_x >= layout_map_width) continue;
-        if (screen_y < 0) continue; // Check later against viewport height
+        if (screen_y < 0) continue;
 
-        if (!map->tiles[entities[i].x][entities[i].y].visible) continue;
-        
         int win_y = screen_y + 1;
         if (win_y >= MAP_VIEW_HEIGHT) continue;
 
-        wattron(win_map, COLOR_PAIR(entities[i].color_pair));
-        mvwaddch(win_map, win_y, screen_x, entities[i].symbol);
-        wattroff(win_map, COLOR_PAIR(entities[i].color_pair));
+        if (!view->tiles[entities[i].x - view->x0][entities[i].y - view->y0].visible) continue;
+
+        uint8_t attr = (entities[i].id == target_id) ? UI_ATTR_REVERSE : 0;
+        fb_put(r, screen_x, win_y, (unsigned char)entities[i].symbol, attr, entities[i].color_pair);
     }
     
     // 3. Render Player
@@ -386,14 +642,20 @@ void ui_render_map(Map* map, const Entity* player, const Entity entities[], int
         int screen_y = player->y - cam_y;
         
         // Should be center typically, but clamped at edges
-        
         int win_y = screen_y + 1;
         if (win_y < MAP_VIEW_HEIGHT && screen_x >= 0 && screen_x < layout_map_width) {
-            wattron(win_map, COLOR_PAIR(player->color_pair));
-            mvwaddch(win_map, win_y, screen_x, player->symbol);
-            wattroff(win_map, COLOR_PAIR(player->color_pair));
+            fb_put(r, screen_x, win_y, (unsigned char)player->symbol, 0, player->color_pair);
         }
     }
+
+    // Cells covered by an entity stop animating
+    int kept = 0;
+    for (int i = 0; i < anim_count; i++) {
+        const UIAnimCell* a = &anim_cells[i];
+        UICell expected = anim_glyph(a, anim_step);
+        if (cell_equal(&frame[a->sy][a->sx], &expected)) anim_cells[kept++] = *a;
+    }
+    anim_count = kept;
 }
 
 // ----------------------------------------------------------------------------
@@ -401,27 +663,21 @@ void ui_render_map(Map* map, const Entity* player, const Entity entities[], int
 // ----------------------------------------------------------------------------
 
 void ui_render_creator_menu(const char* title, const char** items, int count, int selection, const char* description) {
-    // 1. Render List in Map Window (Left)
-    werase(win_map);
-    box(win_map, 0, 0);
-    mvwprintw(win_map, 0, 2, "[ %s ]", title);
+    // 1. Render List in Map Area (Left)
+    fb_fill(&rect_map, BLANK);
+    fb_box(&rect_map, 2);
+    fb_print(&rect_map, 2, 0, 0, 2, "[ %s ]", title);
     
     int y = 2;
     for (int i = 0; i < count; i++) {
-        if (i == selection) {
-            wattron(win_map, A_REVERSE | A_BOLD);
-        }
-        mvwprintw(win_map, y++, 2, " %s ", items[i]);
-        if (i == selection) {
-            wattroff(win_map, A_REVERSE | A_BOLD);
-        }
+        uint8_t attrs = (i == selection) ? (UI_ATTR_REVERSE | UI_ATTR_BOLD) : 0;
+        fb_print(&rect_map, 2, y++, attrs, 2, " %s ", items[i]);
     }
-    wrefresh(win_map);
 
-    // 2. Render Description in Panel Window (Right)
-    werase(win_panel);
-    box(win_panel, 0, 0);
-    mvwprintw(win_panel, 1, 2, "Details:");
+    // 2. Render Description in Panel (Right)
+    fb_fill(&rect_panel, BLANK);
+    fb_box(&rect_panel, 2);
+    fb_print(&rect_panel, 2, 1, 0, 2, "Details:");
     
     // Word wrap description manually
     int desc_y = 3;
@@ -455,17 +711,15 @@ void ui_render_creator_menu(const char* title, const char** items, int count, in
              chunk_len = space_left;
         }
 
-        mvwprintw(win_panel, desc_y++, desc_x, "%.*s", chunk_len, description + cursor);
+        fb_print(&rect_panel, desc_x, desc_y++, 0, 2, "%.*s", chunk_len, description + cursor);
         cursor += chunk_len;
     }
     
-    wrefresh(win_panel);
-    
     // 3. Clear others
-    werase(win_log);
-    werase(win_input);
-    wrefresh(win_log);
-    wrefresh(win_input);
+    anim_count = 0;
+    fb_fill(&rect_log, BLANK);
+    fb_fill(&rect_input, BLANK);
+    ui_refresh();
 }
 
 // ----------------------------------------------------------------------------
@@ -473,161 +727,305 @@ void ui_render_creator_menu(const char* title, const char** items, int count, in
 // ----------------------------------------------------------------------------
 
 void ui_open_menu(void) {
-    if (win_menu) return; // Already open
+    if (menu_open) return; // Already open
     
     int w = 40;
     int h = 18;
-    int x = (80 - w) / 2; // Center on screen (assuming 80 wide term)
-    int y = (24 - h) / 2;
+    int x = (UI_SCREEN_WIDTH - w) / 2; // Center on screen
+    int y = (UI_SCREEN_HEIGHT - h) / 2;
     
-    win_menu = newwin(h, w, y, x);
-    wbkgd(win_menu, COLOR_PAIR(4)); // Cyan border style
-    keypad(win_menu, TRUE);
+    rect_menu = (UIRect){x, y, w, h};
+    menu_open = true;
+    fb_fill(&rect_menu, (UICell){' ', 0, 4}); // Cyan border style
 }
 
 void ui_close_menu(void) {
-    if (win_menu) {
-        delwin(win_menu);
-        win_menu = NULL;
-    }
-    // Force full repaint of underlying map next frame
-    touchwin(win_map); 
+    menu_open = false;
+    // The next frame repaints the map underneath
 }
 
 void ui_render_menu(const Entity* player) {
-    if (!win_menu) return;
+    if (!menu_open) return;
     
-    // "Frozen" Background:
-    // We do NOT erase win_map. We just refresh it to ensure it stays visible under the menu.
-    // However, ncurses might overwrite if we don't touch.
-    // If we simply wrefresh(win_map) then wrefresh(win_menu), menu pops on top.
+    // "Frozen" Background: the map stays in the framebuffer under the menu
+    const UIRect* r = &rect_menu;
+    fb_box(r, 4);
     
-    // Box
-    box(win_menu, 0, 0);
-    
-    mvwprintw(win_menu, 0, 2, "[ Status ]");
+    fb_print(r, 2, 0, 0, 4, "[ Status ]");
     
     // Content
     int y = 2;
-    mvwprintw(win_menu, y++, 2, "Name: %s", player->name);
+    fb_print(r, 2, y++, 0, 4, "Name: %s", player->name);
     y++;
-    mvwprintw(win_menu, y++, 2, "Job:  %s Lv.%d", entity_get_job_name(player->main_job), player->current_level);
-    mvwprintw(win_menu, y++, 2, "Race: %s", entity_get_race_name(player->race));
+    fb_print(r, 2, y++, 0, 4, "Job:  %s Lv.%d", entity_get_job_name(player->main_job), player->current_level);
+    fb_print(r, 2, y++, 0, 4, "Race: %s", entity_get_race_name(player->race));
     y++;
-    mvwprintw(win_menu, y++, 2, "HP:   %d / %d", player->resources.hp, player->resources.max_hp);
-    mvwprintw(win_menu, y++, 2, "MP:   %d / %d", player->resources.mp, player->resources.max_mp);
-    mvwprintw(win_menu, y++, 2, "TP:   %d", player->resources.tp);
+    fb_print(r, 2, y++, 0, 4, "HP:   %d / %d", player->resources.hp, player->resources.max_hp);
+    fb_print(r, 2, y++, 0, 4, "MP:   %d / %d", player->resources.mp, player->resources.max_mp);
+    fb_print(r, 2, y++, 0, 4, "TP:   %d", player->resources.tp);
     y++;
-    mvwprintw(win_menu, y++, 2, "STR:  %d", player->current_stats.str);
-    mvwprintw(win_menu, y++, 2, "DEX:  %d", player->current_stats.dex);
-    mvwprintw(win_menu, y++, 2, "VIT:  %d", player->current_stats.vit);
+    fb_print(r, 2, y++, 0, 4, "STR:  %d", player->current_stats.str);
+    fb_print(r, 2, y++, 0, 4, "DEX:  %d", player->current_stats.dex);
+    fb_print(r, 2, y++, 0, 4, "VIT:  %d", player->current_stats.vit);
     y++;
-    mvwprintw(win_menu, y++, 2, "ATK:  %d", entity_get_derived_attack(player));
-    mvwprintw(win_menu, y++, 2, "DEF:  %d", entity_get_derived_defense(player));
+    fb_print(r, 2, y++, 0, 4, "ATK:  %d", entity_get_derived_attack(player));
+    fb_print(r, 2, y++, 0, 4, "DEF:  %d", entity_get_derived_defense(player));
     
     y++;
-    mvwprintw(win_menu, y++, 2, "EXP:  %d / %d", player->job_exp[player->main_job], entity_get_tnl(player->current_level));
+    fb_print(r, 2, y++, 0, 4, "EXP:  %d / %d", player->job_exp[player->main_job], entity_get_tnl(player->current_level));
 
-    mvwprintw(win_menu, 16, 2, "[ESC] Close");
+    fb_print(r, 2, 16, 0, 4, "[ESC] Close");
 }
 
-void ui_render_stats(const Entity* player) {
-    wattron(win_panel, COLOR_PAIR(2));
-    box(win_panel, 0, 0);
-    mvwprintw(win_panel, 1, 2, "Name: %s", player->name);
-    mvwprintw(win_panel, 3, 2, "HP: %d/%d", player->resources.hp, player->resources.max_hp);
-    mvwprintw(win_panel, 4, 2, "TP: %d", player->resources.tp);
-    mvwprintw(win_panel, 6, 2, "Time: %ld", turn_get_current_time());
-    mvwprintw(win_panel, 7, 2, "Pos:  %d, %d", player->x, player->y);
+void ui_render_stats(const Entity* player, long time) {
+    const UIRect* r = &rect_panel;
+    fb_box(r, 2);
+    fb_print(r, 2, 1, 0, 2, "Name: %s", player->name);
+    fb_print(r, 2, 3, 0, 2, "HP: %d/%d", player->resources.hp, player->resources.max_hp);
+    fb_print(r, 2, 4, 0, 2, "TP: %d", player->resources.tp);
+    fb_print(r, 2, 6, 0, 2, "Time: %ld", time);
+    fb_print(r, 2, 7, 0, 2, "Pos:  %d, %d", player->x, player->y);
     
     if (player->is_engaged) {
-        mvwprintw(win_panel, 8, 2, "[ENGAGED]");
+        fb_print(r, 2, 8, 0, 2, "[ENGAGED]");
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Minimap
+// ----------------------------------------------------------------------------
+
+#define MINIMAP_ROW 10 // Panel row of the minimap divider
+
+// The whole map at `level`, centred in r, with the player marked
+static void draw_minimap(const UIRect* r, const MapView* view, const Entity* player, int level) {
+    int w = (view->width + (1 << level) - 1) >> level;
+    int h = (view->height + (1 << level) - 1) >> level;
+    int ox = (r->w - w) / 2;
+    int oy = (r->h - h) / 2;
+    if (ox < 0) ox = 0;
+    if (oy < 0) oy = 0;
+
+    for (int cy = 0; cy < h && cy < r->h; cy++) {
+        for (int cx = 0; cx < w && cx < r->w; cx++) {
+            const MapMinimapCell* c = minimap_cell(&view->minimap, view->width, view->height, level, cx, cy);
+            UICell g = minimap_glyphs[c->kind][c->mask];
+            fb_put(r, ox + cx, oy + cy, g.ch, g.attr, g.pair);
+        }
     }
-    wattroff(win_panel, COLOR_PAIR(2));
+
+    cursor_x = r->x + ox + (player->x >> level);
+    cursor_y = r->y + oy + (player->y >> level);
+    fb_put(r, ox + (player->x >> level), oy + (player->y >> level), '@', UI_ATTR_BOLD, 1);
+}
+
+void ui_render_minimap(const MapView* view, const Entity* player) {
+    const UIRect* p = &rect_panel;
+    for (int x = 1; x < p->w - 1; x++) fb_put(p, x, MINIMAP_ROW, GLYPH_HLINE, 0, 2);
+    fb_put(p, 0, MINIMAP_ROW, GLYPH_LTEE, 0, 2);
+    fb_put(p, p->w - 1, MINIMAP_ROW, GLYPH_RTEE, 0, 2);
+    fb_print(p, 2, MINIMAP_ROW, 0, 2, "[ Map ]");
+
+    UIRect area = {p->x + 1, p->y + MINIMAP_ROW + 1, p->w - 2, p->h - MINIMAP_ROW - 2};
+    int saved_x = cursor_x, saved_y = cursor_y;
+    draw_minimap(&area, view, player, minimap_fit_level(view->width, view->height, area.w, area.h));
+    cursor_x = saved_x; // The input line keeps the cursor
+    cursor_y = saved_y;
+}
+
+void ui_render_overview(const MapView* view, const Entity* player) {
+    ui_clear();
+    UIRect screen = {0, 0, UI_SCREEN_WIDTH, UI_SCREEN_HEIGHT};
+    UIRect area = {1, 1, UI_SCREEN_WIDTH - 2, UI_SCREEN_HEIGHT - 2};
+    int level = minimap_fit_level(view->width, view->height, area.w, area.h);
+
+    fb_box(&screen, 4);
+    fb_print(&screen, 2, 0, UI_ATTR_BOLD, 4, "[ %s ]", view->name);
+    fb_print(&screen, 2, screen.h - 1, 0, 4, "[ 1 cell = %dx%d tiles ]", 1 << level, 1 << level);
+    fb_print(&screen, screen.w - 17, screen.h - 1, 0, 4, "[ Any key ]");
+    draw_minimap(&area, view, player, level); // Cursor rests on the player
+    ui_refresh();
 }
 
 void ui_render_log(void) {
-    wattron(win_log, COLOR_PAIR(2));
-    // Render last N lines
-    int y = 0;
+    // Render last N lines, formatting only what is on screen
+    EvlogRecord lines[LOG_HEIGHT];
+    int count = 0;
     
-    int start_idx = (log_count > LOG_HEIGHT) ? (log_count - LOG_HEIGHT) : 0;
-    for (int i = start_idx; i < log_count; i++) {
-        mvwprintw(win_log, y++, 1, "%s", log_history[i]);
+    uint64_t head = evlog_head();
+    uint64_t oldest = head > EVLOG_CAPACITY ? head - EVLOG_CAPACITY : 0;
+    for (uint64_t idx = head; idx > oldest && count < LOG_HEIGHT; idx--) {
+        if (evlog_read(idx - 1, &lines[count])) count++;
+    }
+    
+    int y = 0;
+    char buf[64];
+    for (int i = count - 1; i >= 0; i--) {
+        evlog_format(&lines[i], buf, sizeof(buf));
+        fb_print(&rect_log, 1, y++, 0, 2, "%s", buf);
     }
-    wattroff(win_log, COLOR_PAIR(2));
 }
 
 void ui_render_input_line(const char* current_input) {
-    wattron(win_input, COLOR_PAIR(2));
-    mvwprintw(win_input, 0, 0, "> %s", current_input);
-    wattroff(win_input, COLOR_PAIR(2));
+    cursor_x = fb_print(&rect_input, 0, 0, 0, 2, "> %s", current_input);
+    cursor_y = rect_input.y;
+}
+
+static void present(int y0, int y1) {
+    if (backend == UI_BACKEND_ANSI) {
+        fb_flush_ansi(y0, y1);
+        term_cursor(cursor_x, cursor_y, cursor_shown == 1);
+        term_flush(); // One write per frame
+        return;
+    }
+    fb_flush(y0, y1);
+    move(cursor_y, cursor_x);
+    refresh();
 }
 
 void ui_refresh(void) {
-    wrefresh(win_map);
-    wrefresh(win_panel);
-    wrefresh(win_log);
-    wrefresh(win_input);
-    if (win_menu) wrefresh(win_menu);
+    present(0, UI_SCREEN_HEIGHT);
+}
+
+int ui_animation_timeout(void) {
+    if (anim_count == 0 || menu_open) return -1;
+    long wait = (anim_step + 1) * ANIM_STEP_MS - anim_now_ms();
+    return wait > 0 ? (int)wait : 0;
+}
+
+void ui_animate(void) {
+    if (anim_count == 0 || menu_open) return;
+    long step = anim_now_ms() / ANIM_STEP_MS;
+    if (step == anim_step) return;
+    anim_step = step;
+
+    int y0 = UI_SCREEN_HEIGHT, y1 = 0;
+    for (int i = 0; i < anim_count; i++) {
+        const UIAnimCell* a = &anim_cells[i];
+        frame[a->sy][a->sx] = anim_glyph(a, step);
+        if (a->sy < y0) y0 = a->sy;
+        if (a->sy >= y1) y1 = a->sy + 1;
+    }
+    present(y0, y1);
 }
 
 void ui_log(const char* fmt, ...) {
-    char buf[64];
+    char buf[EVLOG_TEXT_MAX + 1];
     va_list args;
     va_start(args, fmt);
     vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
 
-    if (log_count < MAX_LOG_LINES) {
-        strcpy(log_history[log_count++], buf);
-    } else {
-        // Shift up
-        for (int i=1; i < MAX_LOG_LINES; i++) {
-            strcpy(log_history[i-1], log_history[i]);
+    // Free-form text; hot paths log coded records through evlog directly
+    evlog_text(buf);
+}
+
+// Keys read ahead by ui_pending_keys, handed out before the terminal's
+#define UI_KEY_QUEUE 64
+static int key_queue[UI_KEY_QUEUE];
+static int key_head = 0;
+static int key_count = 0;
+
+static int read_key(int timeout_ms) {
+    if (backend == UI_BACKEND_ANSI) return term_read_key(timeout_ms);
+    timeout(timeout_ms);
+    return getch();
+}
+
+static int next_key(int timeout_ms) {
+    if (key_count > 0) {
+        int key = key_queue[key_head];
+        key_head = (key_head + 1) % UI_KEY_QUEUE;
+        key_count--;
+        return key;
+    }
+    return read_key(timeout_ms);
+}
+
+int ui_pending_keys(void) {
+    while (key_count < UI_KEY_QUEUE) {
+        int key = read_key(0);
+        if (key == ERR) break;
+        key_queue[(key_head + key_count) % UI_KEY_QUEUE] = key;
+        key_count++;
+    }
+    return key_count;
+}
+
+void ui_flush_input(void) {
+    key_count = 0;
+    while (read_key(0) != ERR) {}
+}
+
+// ANSI backend: a minimal line editor drawn through the framebuffer
+static void ansi_get_string(const char* prompt, char* buffer, int max_len) {
+    int len = 0;
+    buffer[0] = 0;
+    show_cursor(true);
+
+    for (;;) {
+        fb_fill(&rect_input, BLANK);
+        int x = prompt ? fb_print(&rect_input, 0, 0, 0, 2, "%s ", prompt) : 0;
+        cursor_x = fb_print(&rect_input, x, 0, 0, 2, "%s", buffer);
+        cursor_y = rect_input.y;
+        present(rect_input.y, rect_input.y + 1);
+
+        int key = next_key(-1);
+        if (key == '\r' || key == '\n' || key == KEY_ENTER) break;
+        if (key == KEY_BACKSPACE) {
+            if (len > 0) buffer[--len] = 0;
+        } else if (key >= 32 && key < 127 && len < max_len - 1) {
+            buffer[len++] = (char)key;
+            buffer[len] = 0;
         }
-        strcpy(log_history[MAX_LOG_LINES-1], buf);
     }
+    show_cursor(false);
 }
 
 void ui_get_string(const char* prompt, char* buffer, int max_len) {
-    wtimeout(win_input, -1); // Force blocking for string input
+    if (backend == UI_BACKEND_ANSI) {
+        ansi_get_string(prompt, buffer, max_len);
+        return;
+    }
+
+    timeout(-1); // Force blocking for string input
     echo();
-    curs_set(1);
+    show_cursor(true);
     
-    // Clear input line first
-    werase(win_input);
+    // Clear input line first; ncurses echoes straight to the terminal
+    int y = rect_input.y;
+    attr_set(A_NORMAL, 2, NULL);
+    move(y, 0);
+    for (int x = 0; x < rect_input.w; x++) addch(' ');
     
     // Print prompt if provided
-    if (prompt) {
-        mvwprintw(win_input, 0, 0, "%s ", prompt);
-        // The cursor stays at end of print
-    } else {
-        wmove(win_input, 0, 0); 
-    }
-    wrefresh(win_input); // Ensure prompt is visible
+    if (prompt) mvprintw(y, 0, "%s ", prompt);
+    else move(y, 0);
+    refresh(); // Ensure prompt is visible
     
-    wgetnstr(win_input, buffer, max_len);
+    // getnstr reads from curses; give it back anything read ahead (LIFO)
+    for (int i = key_count - 1; i >= 0; i--) ungetch(key_queue[(key_head + i) % UI_KEY_QUEUE]);
+    key_count = 0;
+
+    getnstr(buffer, max_len);
     noecho();
-    curs_set(0);
+    show_cursor(false);
+
+    fb_invalidate(y, y + 1); // Whatever was typed is on screen, not in the frame
 }
 
 int ui_get_input(char* input_buffer, int max_len, int timeout_ms) {
     (void) input_buffer;
     (void) max_len;
     
-    wtimeout(win_input, timeout_ms); // Set timeout
-    curs_set(1); 
-    int ch = wgetch(win_input);
-    curs_set(0);
+    if (key_count == 0) show_cursor(true); // Queued keys need no cursor
+    int ch = next_key(timeout_ms);
     
     if (ch == ERR) {
-        return ERR;
+        return ERR; // Cursor stays up while idle
     }
+    show_cursor(false);
     
     return ch;
 }
 
-void ui_tick_animation(void) {
-    animation_frame++;
-}
@@ -1,11 +1,19 @@
 #ifndef UI_H
 #define UI_H
 
+#include <stdio.h>
 #include "game.h"
 
+typedef enum {
+    UI_BACKEND_CURSES, // Default
+    UI_BACKEND_ANSI    // Raw VT sequences, one write() per frame (--ansi)
+} UIBackend;
+
 // Init/Cleanup ncurses
 // Init/Cleanup ncurses
+void ui_set_backend(UIBackend backend); // Before ui_init
 void ui_init(void);
+void ui_init_stream(FILE* out, FILE* in); // Headless: draw to a stream instead of the tty ($TERM decides the escapes)
 void ui_cleanup(void);
 
 typedef enum {
@@ -15,12 +23,35 @@ typedef enum {
 
 void ui_set_layout(UILayout layout);
 
+// Map View
+// All the map views read: the viewport's tiles (plus the one-tile margin wall
+// joins look at) with their smell and sound, and the map's name, size and
+// minimap. Filled from the map for one player position, so a renderer on
+// another thread gets a few KB instead of the whole Map.
+#define UI_MAP_VIEW_COLS 56 // Widest map area (UI_LAYOUT_GAME) + margins
+#define UI_MAP_VIEW_ROWS 18 // Map area rows + top margin
+
+typedef struct {
+    char name[64];
+    int width, height;  // Of the whole map
+    int x0, y0, x1, y1; // Tiles held: [x0, x1) x [y0, y1)
+    Tile tiles[UI_MAP_VIEW_COLS][UI_MAP_VIEW_ROWS];
+    uint8_t smell[UI_MAP_VIEW_COLS][UI_MAP_VIEW_ROWS];
+    uint8_t sound[UI_MAP_VIEW_COLS][UI_MAP_VIEW_ROWS]; // SoundState
+    MapMinimap minimap; // Copied only when its version changes
+} MapView;
+
+void ui_map_view_fill(MapView* view, const Map* map, const Entity* player);
+
 // Rendering
 void ui_clear(void);
-void ui_render_map(Map* map, const Entity* player, const Entity entities[], int entity_count, RenderMode mode);
-void ui_render_stats(const Entity* player);
+void ui_render_map(const MapView* view, const Entity* player, const Entity entities[], int entity_count, RenderMode mode);
+void ui_set_target(EntityID id); // Drawn highlighted by ui_render_map; -1 for none
+void ui_render_stats(const Entity* player, long time);
 void ui_render_log(void);
 void ui_render_input_line(const char* current_input);
+void ui_render_minimap(const MapView* view, const Entity* player);  // Lower half of the stats panel
+void ui_render_overview(const MapView* view, const Entity* player); // Full screen /map, drawn and refreshed
 void ui_refresh(void);
 
 // Menu
@@ -35,7 +66,17 @@ void ui_render_creator_menu(const char* title, const char** items, int count, in
 // However, since we have a command line, we need to handle character appending.
 // For the scaffold, we might return a simpler key code or update a buffer.
 int ui_get_input(char* input_buffer, int max_len, int timeout_ms);
-void ui_tick_animation(void);
+
+// Type-ahead: read every key already waiting (without blocking) into a
+// queue that ui_get_input serves first, and return how many are queued.
+// ui_flush_input discards them, e.g. when something interrupts a run.
+int ui_pending_keys(void);
+void ui_flush_input(void);
+
+// Animation runs on its own clock. Wait at most ui_animation_timeout() ms
+// for input (-1 when nothing on screen animates), then call ui_animate.
+int ui_animation_timeout(void);
+void ui_animate(void);
 
 // Blocking string input at bottom line
 void ui_get_string(const char* prompt, char* buffer, int max_len);
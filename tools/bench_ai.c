@@ -0,0 +1,158 @@
+// AI Behaviour Benchmark
+// Runs monster turns through src/ai.c on an open headless map and reports the
+// cost per turn as the number of behaviour families grows. Families are
+// generated as monsters.txt-style data, so this also exercises the loader.
+//
+// Usage: bench_ai [-n turns] [-s seed]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+#include "ai.h"
+#include "data.h"
+#include "game.h"
+#include "spatial.h"
+#include "turn.h"
+#include "rng.h"
+
+#define MAP_SIZE 128
+
+// The benchmark runs without the game loop or the log window.
+Game g_game;
+
+void ui_log(const char* fmt, ...) {
+    (void)fmt;
+}
+
+Entity* game_get_entity(EntityID id) {
+    if (id == g_game.player.id) return &g_game.player;
+    int idx = id - ENTITY_ID_BASE;
+    if (idx < 0 || idx >= g_game.entity_count) return NULL;
+    return &g_game.entities[idx];
+}
+
+// ----------------------------------------------------------------------------
+// Setup
+// ----------------------------------------------------------------------------
+
+// Each family: rest a while, hop, glance around, back to rest
+static bool write_families(const char* path, int families) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    for (int i = 0; i < families; i++) {
+        fprintf(f, "@Fam%d:REST=WAIT_RANDOM,MIN=50,MAX=150,DONE=HOP\n", i);
+        fprintf(f, "@Fam%d:HOP=WANDER,DONE=LOOK,FAIL=REST\n", i);
+        fprintf(f, "@Fam%d:LOOK=HOLD,FAIL=PAUSE\n", i);
+        fprintf(f, "@Fam%d:PAUSE=WAIT,TICKS=%d,DONE=REST\n", i, 20 + i);
+    }
+    for (int i = 0; i < families; i++) {
+        fprintf(f, "Mon%d:HP=30,LVL=1,AI=Fam%d\n", i, i);
+    }
+    fclose(f);
+    return true;
+}
+
+static void setup_world(int families) {
+    memset(&g_game, 0, sizeof(Game));
+    Map* map = &g_game.current_map;
+    map->width = MAP_SIZE;
+    map->height = MAP_SIZE;
+    for (int x = 0; x < MAP_SIZE; x++) {
+        for (int y = 0; y < MAP_SIZE; y++) {
+            bool edge = (x == 0 || y == 0 || x == MAP_SIZE - 1 || y == MAP_SIZE - 1);
+            map->tiles[x][y].type = edge ? TILE_WALL : TILE_FLOOR;
+        }
+    }
+
+    map_index_free_tiles(map);
+
+    g_game.player.id = 0;
+    g_game.player.type = ENTITY_PLAYER;
+    g_game.player.x = MAP_SIZE / 2;
+    g_game.player.y = MAP_SIZE / 2;
+    g_game.player.is_active = true;
+
+    turn_init();
+    spatial_reset();
+    ai_lod_reset();
+    ai_lod_set_radius(MAP_SIZE); // Everyone stays active
+
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        int x, y;
+        map_random_free_tile(map, &x, &y);
+
+        Entity* e = &g_game.entities[i];
+        data_spawn_monster(i % families, e, ENTITY_ID_BASE + i, x, y);
+        map_set_occupied(map, x, y, true);
+        g_game.entity_count++;
+        spatial_insert(e);
+        turn_add_event(rand() % 100, e->id, EVENT_MOVE);
+    }
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(void) {
+    fprintf(stderr, "Usage: bench_ai [-n turns] [-s seed]\n");
+}
+
+int main(int argc, char** argv) {
+    long turns = 2000000;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) { usage(); return 1; }
+        if (strcmp(argv[i], "-n") == 0) turns = atol(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0) seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else { usage(); return 1; }
+    }
+    if (turns < 1) turns = 1;
+
+    char path[] = "/tmp/bench_ai_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "Could not create a temporary data file\n");
+        return 1;
+    }
+    close(fd);
+
+    static const int FAMILIES[] = {1, 4, 16, 32};
+    printf("%-9s %-7s %12s %10s\n", "families", "states", "turns/s", "ns/turn");
+
+    for (size_t f = 0; f < sizeof(FAMILIES) / sizeof(FAMILIES[0]); f++) {
+        int families = FAMILIES[f];
+        if (!write_families(path, families)) {
+            fprintf(stderr, "Could not write %s\n", path);
+            return 1;
+        }
+        data_init_loaders();
+        data_load_monsters(path);
+        ai_compile_behaviours();
+
+        srand(seed);
+        rng_seed(seed); // AI choices
+        setup_world(families);
+
+        double start = now_seconds();
+        for (long t = 0; t < turns; t++) {
+            GameEvent evt = turn_pop_event();
+            Entity* e = game_get_entity(evt.entity_id);
+            ai_take_turn(e, &g_game.current_map, &g_game);
+        }
+        double elapsed = now_seconds() - start;
+
+        printf("%-9d %-7d %12.0f %10.1f\n", families, data_ai_state_count(),
+            turns / elapsed, elapsed * 1e9 / turns);
+    }
+
+    unlink(path);
+    return 0;
+}
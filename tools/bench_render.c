@@ -0,0 +1,243 @@
+// Render Benchmark
+// Draws game frames through src/ui.c into an ncurses screen opened on a
+// temporary file and reports frames per second and terminal bytes per
+// frame. Every map in data/maps plus synthetic 256x256 zones is drawn in
+// normal, smell and sound view while the player walks, so the camera moves
+// and the log scrolls as in play. -a measures the raw ANSI backend instead
+// of ncurses.
+//
+// Usage: bench_render [-n frames] [-s seed] [-a]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "ui.h"
+#include "evlog.h"
+#include "map.h"
+#include "turn.h"
+
+#define MAPS_DIR "data/maps"
+#define MAX_BENCH_MAPS 32
+#define BENCH_ENTITIES 200
+#define SYNTHETIC_SIZE 256
+
+static Map map;
+static MapView view;
+static Entity player;
+static Entity entities[BENCH_ENTITIES];
+
+static FILE* screen_out;
+
+// ----------------------------------------------------------------------------
+// Maps
+// ----------------------------------------------------------------------------
+
+// Rooms on a 16-tile grid with doorways, pools, bridges and teleports, so
+// every glyph the renderer knows shows up
+static void build_synthetic(int variant) {
+    memset(&map, 0, sizeof(Map));
+    snprintf(map.name, sizeof(map.name), "Synthetic %d", variant);
+    map.width = SYNTHETIC_SIZE;
+    map.height = SYNTHETIC_SIZE;
+
+    for (int x = 0; x < map.width; x++) {
+        for (int y = 0; y < map.height; y++) {
+            bool grid = (x % 16 == 0) || (y % 16 == 0);
+            bool doorway = (x % 16 == 8) || (y % 16 == 8);
+            map.tiles[x][y].type = (grid && !doorway) ? TILE_WALL : TILE_FLOOR;
+        }
+    }
+    for (int r = 0; r < 64; r++) {
+        int rx = 16 * (rand() % 16) + 3;
+        int ry = 16 * (rand() % 16) + 3;
+        for (int x = rx; x < rx + 10; x++) {
+            for (int y = ry; y < ry + 4; y++) map.tiles[x][y].type = (y == ry + 2) ? TILE_BRIDGE : TILE_WATER;
+        }
+    }
+    for (int t = 0; t < 32; t++) {
+        map.tiles[1 + rand() % (SYNTHETIC_SIZE - 2)][1 + rand() % (SYNTHETIC_SIZE - 2)].type = TILE_TELEPORT;
+    }
+}
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static int list_maps(char* paths[MAX_BENCH_MAPS]) {
+    DIR* dir = opendir(MAPS_DIR);
+    if (!dir) return 0;
+
+    int count = 0;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) && count < MAX_BENCH_MAPS) {
+        size_t len = strlen(ent->d_name);
+        if (len < 5 || strcmp(ent->d_name + len - 4, ".map") != 0) continue;
+        paths[count] = malloc(sizeof(MAPS_DIR) + len + 1);
+        sprintf(paths[count], "%s/%s", MAPS_DIR, ent->d_name);
+        count++;
+    }
+    closedir(dir);
+    qsort(paths, count, sizeof(char*), compare_names);
+    return count;
+}
+
+// Everything lit, mobs scattered, scent and sound laid from the centre
+static void prepare_map(void) {
+    for (int x = 0; x < map.width; x++) {
+        for (int y = 0; y < map.height; y++) {
+            map.tiles[x][y].visible = true;
+            map.tiles[x][y].explored = true;
+        }
+    }
+
+    memset(&player, 0, sizeof(Entity));
+    player.id = 0;
+    player.symbol = '@';
+    player.color_pair = 1;
+    player.is_active = true;
+    strcpy(player.name, "Bench");
+    player.resources.hp = player.resources.max_hp = 100;
+
+    memset(entities, 0, sizeof(entities));
+    for (int i = 0; i < BENCH_ENTITIES; i++) {
+        entities[i].id = i + 1;
+        entities[i].x = rand() % map.width;
+        entities[i].y = rand() % map.height;
+        entities[i].symbol = 'r';
+        entities[i].color_pair = 3;
+        entities[i].is_active = true;
+    }
+
+    int cx = map.width / 2, cy = map.height / 2;
+    for (int i = 0; i < 20; i++) map_update_smell(&map, cx + i % 5, cy + i / 5);
+    map_update_sound(&map, cx, cy, 20);
+}
+
+// Serpentine walk over the map, one tile per frame
+static void walk_to(long frame) {
+    long row = frame / map.width;
+    long col = frame % map.width;
+    player.x = (row % 2 == 0) ? (int)col : map.width - 1 - (int)col;
+    player.y = (int)((row * 5) % map.height);
+}
+
+// ----------------------------------------------------------------------------
+// Measurement
+// ----------------------------------------------------------------------------
+
+static long screen_bytes(void) {
+    fflush(screen_out);
+    struct stat st;
+    if (fstat(fileno(screen_out), &st) != 0) return 0;
+    return (long)st.st_size;
+}
+
+static void reset_screen_bytes(void) {
+    fflush(screen_out);
+    if (ftruncate(fileno(screen_out), 0) != 0) return;
+    rewind(screen_out);
+}
+
+static void draw_frame(RenderMode mode) {
+    ui_clear();
+    ui_map_view_fill(&view, &map, &player); // The game's simulation thread does this per snapshot
+    ui_render_map(&view, &player, entities, BENCH_ENTITIES, mode);
+    ui_render_stats(&player, turn_get_current_time());
+    ui_render_log();
+    ui_render_input_line("");
+    ui_refresh();
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char* MODE_NAMES[] = {"normal", "smell", "sound"};
+
+static void bench_map(long frames) {
+    static const RenderMode MODES[] = {RENDER_MODE_NORMAL, RENDER_MODE_SMELL, RENDER_MODE_SOUND};
+
+    for (int m = 0; m < 3; m++) {
+        walk_to(0);
+        draw_frame(MODES[m]); // First frame repaints everything; not counted
+        reset_screen_bytes();
+
+        long bytes = 0;
+        double start = now_seconds();
+        for (long f = 1; f <= frames; f++) {
+            walk_to(f);
+            if (f % 8 == 0) ui_log("Frame %ld", f);
+            draw_frame(MODES[m]);
+
+            if (f % 1024 == 0) { // Keep the capture file small
+                bytes += screen_bytes();
+                reset_screen_bytes();
+            }
+        }
+        bytes += screen_bytes();
+        double elapsed = now_seconds() - start;
+
+        printf("%-24.24s %4dx%-4d %-7s %10.0f %12.1f\n", map.name, map.width, map.height,
+            MODE_NAMES[m], frames / elapsed, (double)bytes / frames);
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "Usage: bench_render [-n frames] [-s seed] [-a]\n");
+}
+
+int main(int argc, char** argv) {
+    long frames = 2000;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-a") == 0) { ui_set_backend(UI_BACKEND_ANSI); continue; }
+        if (i + 1 >= argc) { usage(); return 1; }
+        if (strcmp(argv[i], "-n") == 0) frames = atol(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0) seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else { usage(); return 1; }
+    }
+    if (frames < 1) frames = 1;
+    srand(seed);
+
+    // A real terminal type, so the byte counts mean something
+    setenv("TERM", "xterm-256color", 0);
+    screen_out = tmpfile();
+    FILE* screen_in = fopen("/dev/null", "r");
+    if (!screen_out || !screen_in) {
+        fprintf(stderr, "Could not open the capture streams\n");
+        return 1;
+    }
+
+    evlog_init(NULL);
+    turn_init();
+    ui_init_stream(screen_out, screen_in);
+
+    char* paths[MAX_BENCH_MAPS];
+    int map_count = list_maps(paths);
+
+    printf("%-24s %-9s %-7s %10s %12s\n", "map", "size", "mode", "frames/s", "bytes/frame");
+    for (int i = 0; i < map_count + 2; i++) {
+        if (i < map_count) {
+            map_load_static(&map, paths[i]);
+            free(paths[i]);
+        } else {
+            build_synthetic(i - map_count + 1);
+        }
+        prepare_map();
+        bench_map(frames);
+    }
+
+    ui_cleanup();
+    fclose(screen_in);
+    fclose(screen_out);
+    evlog_shutdown();
+    return 0;
+}
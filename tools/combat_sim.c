@@ -0,0 +1,320 @@
+// Headless Combat Simulator
+// Runs auto-attack engagements through src/combat.c and src/turn.c without the
+// TUI and reports DPS, TP gain and time-to-kill distributions.
+//
+// Usage: combat_sim [-n engagements] [-t threads] [-s seed] [-a SIDE] [-b SIDE]
+//   SIDE = race:job:level     e.g. hume:warrior:10
+//        | monster:Name[:lvl] e.g. monster:Rabbit
+//
+// Side A attacks side B; both auto-attack until one falls. Status effects a
+// hit inflicts (e.g. Worm Poison) pulse as they do in the dungeon.
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <time.h>
+#include "entity.h"
+#include "combat.h"
+#include "turn.h"
+#include "data.h"
+#include "rng.h"
+
+#define MAX_THREADS 64
+#define ENGAGEMENT_TIMEOUT 100000  // Ticks before a fight is called a draw
+#define TTK_BUCKET 10              // Ticks per histogram bucket
+#define TTK_BUCKETS (ENGAGEMENT_TIMEOUT / TTK_BUCKET + 1)
+
+// Combat logs every swing; the simulator has no log window.
+void ui_log(const char* fmt, ...) {
+    (void)fmt;
+}
+
+// Each thread fights one pair at a time; ids 0 and 1 index into it.
+static __thread Entity fighters[2];
+
+Entity* game_get_entity(EntityID id) {
+    if (id < 0 || id > 1) return NULL;
+    return &fighters[id];
+}
+
+// ----------------------------------------------------------------------------
+// Setup
+// ----------------------------------------------------------------------------
+
+static const char* RACE_ARGS[RACE_MAX] = {"hume", "elvaan", "tarutaru", "mithra", "galka", "worm"};
+static const char* JOB_ARGS[JOB_MAX] = {"warrior", "monk", "thief", "blackmage", "whitemage", "redmage", "worm"};
+
+static int find_arg(const char** names, int count, const char* s) {
+    for (int i = 0; i < count; i++) {
+        if (strcasecmp(names[i], s) == 0) return i;
+    }
+    return -1;
+}
+
+// Builds a fully derived combatant from a SIDE spec
+static bool build_side(const char* spec, Entity* out, EntityID id) {
+    char buf[128];
+    strncpy(buf, spec, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    char* parts[3] = {NULL, NULL, NULL};
+    int n = 0;
+    for (char* tok = strtok(buf, ":"); tok && n < 3; tok = strtok(NULL, ":")) parts[n++] = tok;
+    if (n < 2) return false;
+
+    memset(out, 0, sizeof(Entity));
+    int level = 1;
+
+    if (strcasecmp(parts[0], "monster") == 0) {
+        int tmpl = data_find_monster(parts[1]);
+        if (tmpl < 0) {
+            fprintf(stderr, "Unknown monster '%s'\n", parts[1]);
+            return false;
+        }
+        data_spawn_monster(tmpl, out, id, 0, 0);
+        level = out->current_level;
+    } else {
+        int r = find_arg(RACE_ARGS, RACE_MAX, parts[0]);
+        int j = find_arg(JOB_ARGS, JOB_MAX, parts[1]);
+        if (r < 0 || j < 0) {
+            fprintf(stderr, "Unknown race/job in '%s'\n", spec);
+            return false;
+        }
+        out->id = id;
+        out->type = ENTITY_PLAYER;
+        out->is_active = true;
+        out->resources.max_tp = 3000;
+        snprintf(out->name, MAX_NAME_LEN, "%s %s", entity_get_race_name(r), entity_get_job_name(j));
+        entity_init_stats(out, (RaceType)r, (JobType)j);
+    }
+
+    if (n == 3) level = atoi(parts[2]);
+    entity_set_level(out, level);
+    entity_refresh_stats(out);
+    out->resources.hp = out->resources.max_hp;
+    out->resources.mp = out->resources.max_mp;
+    out->target_id = -1;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Simulation
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    // Inputs
+    const Entity* side_a;
+    const Entity* side_b;
+    long engagements;
+    uint64_t seed;
+
+    // Outputs
+    long wins_a, wins_b, draws;
+    long long damage_a, damage_b;  // Includes status damage
+    long long status_a, status_b;  // Status pulse damage dealt by each side
+    long long tp_a;
+    long long swings_a, hits_a;
+    long long ticks;
+    long ttk_hist[TTK_BUCKETS];     // Time for A to kill B
+} SimJob;
+
+static void* sim_thread(void* arg) {
+    SimJob* job = arg;
+    rng_seed(job->seed);
+
+    for (long n = 0; n < job->engagements; n++) {
+        fighters[0] = *job->side_a;
+        fighters[1] = *job->side_b;
+        turn_init();
+
+        combat_engage(&fighters[0], 1);
+        combat_engage(&fighters[1], 0);
+
+        long end_time = ENGAGEMENT_TIMEOUT;
+        while (!turn_queue_is_empty()) {
+            GameEvent evt = turn_pop_event();
+            if (evt.time > ENGAGEMENT_TIMEOUT) break;
+
+            // Status events mirror update_dungeon; a pulse's damage is credited
+            // to the side that inflicted the effect
+            if (evt.type == EVENT_STATUS_EXPIRE) {
+                entity_expire_status(&fighters[evt.entity_id], (StatusEffectType)evt.data);
+                continue;
+            }
+            if (evt.type == EVENT_STATUS_TICK) {
+                Entity* victim = &fighters[evt.entity_id];
+                int hp_before = victim->resources.hp;
+                bool defeated = entity_pulse_status(victim, (StatusEffectType)evt.data);
+                int dealt = hp_before - victim->resources.hp;
+                if (evt.entity_id == 1) {
+                    job->damage_a += dealt;
+                    job->status_a += dealt;
+                } else {
+                    job->damage_b += dealt;
+                    job->status_b += dealt;
+                }
+                if (defeated) {
+                    combat_defeat(victim);
+                    end_time = evt.time;
+                    break;
+                }
+                continue;
+            }
+            if (evt.type != EVENT_ATTACK_READY) continue;
+
+            Entity* attacker = &fighters[evt.entity_id];
+            AttackResult res = combat_handle_attack_ready(attacker, evt.time);
+
+            if (evt.entity_id == 0) {
+                job->damage_a += res.damage;
+                job->tp_a += res.tp_gained;
+                job->swings_a++;
+                if (res.hit) job->hits_a++;
+            } else {
+                job->damage_b += res.damage;
+            }
+
+            if (res.defeated) {
+                end_time = evt.time;
+                break;
+            }
+        }
+
+        job->ticks += end_time;
+        if (!fighters[1].is_active) {
+            job->wins_a++;
+            job->ttk_hist[end_time / TTK_BUCKET]++;
+        } else if (!fighters[0].is_active) {
+            job->wins_b++;
+        } else {
+            job->draws++;
+        }
+    }
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// Reporting
+// ----------------------------------------------------------------------------
+
+static long percentile(const long* hist, long total, double p) {
+    long want = (long)(total * p);
+    long seen = 0;
+    for (int i = 0; i < TTK_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen > want) return (long)i * TTK_BUCKET;
+    }
+    return ENGAGEMENT_TIMEOUT;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(void) {
+    fprintf(stderr, "Usage: combat_sim [-n engagements] [-t threads] [-s seed] [-a SIDE] [-b SIDE]\n");
+    fprintf(stderr, "  SIDE = race:job:level (hume:warrior:10) or monster:Name[:level] (monster:Rabbit)\n");
+}
+
+int main(int argc, char** argv) {
+    long engagements = 1000000;
+    int threads = 4;
+    uint64_t seed = 1;
+    const char* spec_a = "hume:warrior:1";
+    const char* spec_b = "monster:Rabbit";
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) { usage(); return 1; }
+        if (strcmp(argv[i], "-n") == 0) engagements = atol(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0) seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-a") == 0) spec_a = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0) spec_b = argv[++i];
+        else { usage(); return 1; }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (engagements < 1) engagements = 1;
+
+    data_init_loaders();
+    data_load_jobs("data/jobs.txt");
+    data_load_monsters("data/monsters.txt");
+
+    Entity side_a, side_b;
+    if (!build_side(spec_a, &side_a, 0) || !build_side(spec_b, &side_b, 1)) {
+        usage();
+        return 1;
+    }
+
+    static SimJob jobs[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+
+    double start = now_seconds();
+    for (int t = 0; t < threads; t++) {
+        memset(&jobs[t], 0, sizeof(SimJob));
+        jobs[t].side_a = &side_a;
+        jobs[t].side_b = &side_b;
+        jobs[t].engagements = engagements / threads + (t < engagements % threads ? 1 : 0);
+        jobs[t].seed = seed + (uint64_t)t; // rng_seed decorrelates neighbouring seeds
+        pthread_create(&tids[t], NULL, sim_thread, &jobs[t]);
+    }
+
+    // Merge
+    SimJob total;
+    memset(&total, 0, sizeof(total));
+    for (int t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+        total.wins_a += jobs[t].wins_a;
+        total.wins_b += jobs[t].wins_b;
+        total.draws += jobs[t].draws;
+        total.damage_a += jobs[t].damage_a;
+        total.damage_b += jobs[t].damage_b;
+        total.status_a += jobs[t].status_a;
+        total.status_b += jobs[t].status_b;
+        total.tp_a += jobs[t].tp_a;
+        total.swings_a += jobs[t].swings_a;
+        total.hits_a += jobs[t].hits_a;
+        total.ticks += jobs[t].ticks;
+        for (int b = 0; b < TTK_BUCKETS; b++) total.ttk_hist[b] += jobs[t].ttk_hist[b];
+    }
+    double elapsed = now_seconds() - start;
+
+    double seconds = (double)total.ticks / TURN_TICKS_PER_SECOND;
+    long kills = total.wins_a;
+    long ttk_min = -1, ttk_max = 0;
+    for (int b = 0; b < TTK_BUCKETS; b++) {
+        if (total.ttk_hist[b] == 0) continue;
+        if (ttk_min < 0) ttk_min = (long)b * TTK_BUCKET;
+        ttk_max = (long)b * TTK_BUCKET;
+    }
+
+    printf("A: %-20s Lv%-2d HP %-4d ATK %-3d DEF %-3d Delay %d\n", side_a.name, side_a.current_level,
+        side_a.resources.max_hp, side_a.derived.attack, side_a.derived.defense, side_a.derived.delay);
+    printf("B: %-20s Lv%-2d HP %-4d ATK %-3d DEF %-3d Delay %d\n", side_b.name, side_b.current_level,
+        side_b.resources.max_hp, side_b.derived.attack, side_b.derived.defense, side_b.derived.delay);
+    printf("\n");
+    printf("Engagements   %ld on %d thread(s), seed %llu\n", engagements, threads, (unsigned long long)seed);
+    printf("Outcome       A wins %.2f%%  B wins %.2f%%  draws %.2f%%\n",
+        100.0 * total.wins_a / engagements, 100.0 * total.wins_b / engagements, 100.0 * total.draws / engagements);
+    printf("A accuracy    %.2f%%\n", total.swings_a ? 100.0 * total.hits_a / total.swings_a : 0.0);
+    printf("A DPS         %.2f\n", seconds > 0 ? total.damage_a / seconds : 0.0);
+    printf("B DPS         %.2f\n", seconds > 0 ? total.damage_b / seconds : 0.0);
+    if (total.status_a > 0 || total.status_b > 0) {
+        printf("Status DPS    A %.2f  B %.2f\n", seconds > 0 ? total.status_a / seconds : 0.0,
+            seconds > 0 ? total.status_b / seconds : 0.0);
+    }
+    printf("A TP/s        %.2f\n", seconds > 0 ? total.tp_a / seconds : 0.0);
+    if (kills > 0) {
+        printf("TTK (ticks)   min %ld  p50 %ld  p90 %ld  p99 %ld  max %ld\n",
+            ttk_min, percentile(total.ttk_hist, kills, 0.50), percentile(total.ttk_hist, kills, 0.90),
+            percentile(total.ttk_hist, kills, 0.99), ttk_max);
+    }
+    printf("\nWall time     %.3fs (%.0f engagements/s)\n", elapsed, engagements / elapsed);
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Event Log Decoder
+// Prints a binary event log (grindfest.evlog) as text, one record per line.
+//
+// Usage: evlog_decode [-c] [file]
+//   -c  Also print the event code of each record
+
+#include <stdio.h>
+#include <string.h>
+#include "evlog.h"
+
+static const char* CODE_NAMES[EVLOG_CODE_MAX] = {
+    "TEXT", "NAME", "ENGAGE", "ALREADY_ENGAGED", "DISENGAGE", "MISS", "HIT",
+    "CRIT", "DEFEAT", "LEVEL_UP", "STATUS_WEAR", "POISON", "BURROW", "SURFACE", "AGGRO",
+    "STATUS_GAIN", "TEXT_MORE", "WAIT", "BLOCKED", "TARGET", "NO_TARGET",
+    "STATUS_DEFEAT"
+};
+
+int main(int argc, char** argv) {
+    const char* path = "grindfest.evlog";
+    int show_codes = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0) show_codes = 1;
+        else path = argv[i];
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return 1;
+    }
+
+    EvlogFileHeader h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.magic, EVLOG_MAGIC, sizeof(EVLOG_MAGIC)) != 0) {
+        fprintf(stderr, "%s: not an event log\n", path);
+        fclose(f);
+        return 1;
+    }
+    if (h.version != EVLOG_VERSION || h.record_size != sizeof(EvlogRecord)) {
+        fprintf(stderr, "%s: unsupported version %u (record size %u)\n", path, h.version, h.record_size);
+        fclose(f);
+        return 1;
+    }
+
+    EvlogRecord rec;
+    char line[256];
+    long records = 0;
+    while (fread(&rec, sizeof(rec), 1, f) == 1) {
+        if (rec.code == EVLOG_NAME) {
+            rec.text[EVLOG_TEXT_LEN - 1] = '\0';
+            evlog_define_name(rec.aux, rec.text);
+            continue;
+        }
+        evlog_format(&rec, line, sizeof(line));
+        if (show_codes) {
+            const char* code = rec.code < EVLOG_CODE_MAX ? CODE_NAMES[rec.code] : "?";
+            printf("%8lld %-15s %s\n", (long long)rec.tick, code, line);
+        } else {
+            printf("%8lld %s\n", (long long)rec.tick, line);
+        }
+        records++;
+    }
+    fclose(f);
+
+    fprintf(stderr, "%ld records\n", records);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Perfect Hash Check
+// Builds src/phash.c tables over generated name sets, from one key up to the
+// largest table (64 names is MAX_MONSTER_TEMPLATES; command names and their
+// aliases share one table), and checks that every key is found, unknown
+// names are rejected and duplicates refuse to build.
+// Exits non-zero on the first failure.
+//
+// Usage: phash_check
+
+#include <stdio.h>
+#include <string.h>
+#include "phash.h"
+
+#define MAX_KEYS (PHASH_MAX_SLOTS / 2)
+
+static char names[MAX_KEYS][32];
+static const char* keys[MAX_KEYS];
+static PerfectHash ph;
+
+static int check_set(const char* pattern, int count) {
+    for (int i = 0; i < count; i++) {
+        snprintf(names[i], sizeof(names[i]), pattern, i);
+        keys[i] = names[i];
+    }
+    if (!phash_build(&ph, keys, count)) {
+        fprintf(stderr, "%d keys (%s): build failed\n", count, pattern);
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (phash_lookup(&ph, keys, keys[i]) != i) {
+            fprintf(stderr, "%d keys (%s): %s not found\n", count, pattern, keys[i]);
+            return 1;
+        }
+    }
+    char unknown[40];
+    for (int i = 0; i < count; i++) {
+        snprintf(unknown, sizeof(unknown), "%s?", keys[i]);
+        if (phash_lookup(&ph, keys, unknown) != -1) {
+            fprintf(stderr, "%d keys (%s): %s matched\n", count, pattern, unknown);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    static const char* PATTERNS[] = {"Monster %d", "/cmd%02d", "%d"}; // Templates, commands, worst case
+    int failures = 0;
+
+    for (int p = 0; p < 3; p++) {
+        for (int count = 1; count <= MAX_KEYS; count++) failures += check_set(PATTERNS[p], count);
+    }
+
+    // Duplicates and oversized sets are refused, not mis-built
+    check_set("Rabbit %d", 64);
+    strcpy(names[63], names[10]);
+    if (phash_build(&ph, keys, 64)) {
+        fprintf(stderr, "duplicate keys built\n");
+        failures++;
+    }
+    if (phash_build(&ph, keys, MAX_KEYS + 1)) {
+        fprintf(stderr, "%d keys built\n", MAX_KEYS + 1);
+        failures++;
+    }
+
+    if (failures) return 1;
+    printf("phash: 1-%d keys OK\n", MAX_KEYS);
+    return 0;
+}